@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include <cstdint>
 #include <cstring> // memset
 
@@ -177,34 +178,110 @@ using U64 = uint64_t;
     };
 
     // -----------------------
-    // Precomputed tables
+    // Leaper attacks (compile time)
     // -----------------------
-    extern U64 pawn_attacks[2][64];
-    extern U64 knight_attacks[64];
-    extern U64 king_attacks[64];
-    extern U64 bishop_masks[64];
-    extern U64 rook_masks[64];
-    extern U64 bishop_attacks[64][512];
-    extern U64 rook_attacks[64][4096];
+    constexpr U64 mask_pawn_attacks(int side, int square) {
+        const U64 bitboard = 1ULL << square;
+        if (side == 0) // white
+            return ((bitboard >> 7) & not_a_file) | ((bitboard >> 9) & not_h_file);
+        return ((bitboard << 7) & not_h_file) | ((bitboard << 9) & not_a_file);
+    }
+
+    constexpr U64 mask_knight_attacks(int square) {
+        const U64 bitboard = 1ULL << square;
+        return ((bitboard >> 17) & not_h_file)  | ((bitboard >> 15) & not_a_file)
+             | ((bitboard >> 10) & not_hg_file) | ((bitboard >> 6)  & not_ab_file)
+             | ((bitboard << 17) & not_a_file)  | ((bitboard << 15) & not_h_file)
+             | ((bitboard << 10) & not_ab_file) | ((bitboard << 6)  & not_hg_file);
+    }
+
+    constexpr U64 mask_king_attacks(int square) {
+        const U64 bitboard = 1ULL << square;
+        return (bitboard >> 8) | ((bitboard >> 9) & not_h_file) | ((bitboard >> 7) & not_a_file) | ((bitboard >> 1) & not_h_file)
+             | (bitboard << 8) | ((bitboard << 9) & not_a_file) | ((bitboard << 7) & not_h_file) | ((bitboard << 1) & not_a_file);
+    }
+
+    template<typename Mask>
+    constexpr std::array<U64, 64> make_leaper_table(Mask mask) {
+        std::array<U64, 64> table{};
+        for (int square = 0; square < 64; square++) table[square] = mask(square);
+        return table;
+    }
+
+    inline constexpr std::array<std::array<U64, 64>, 2> pawn_attacks = {
+        make_leaper_table([](int square) { return mask_pawn_attacks(0, square); }),
+        make_leaper_table([](int square) { return mask_pawn_attacks(1, square); })
+    };
+    inline constexpr std::array<U64, 64> knight_attacks = make_leaper_table(mask_knight_attacks);
+    inline constexpr std::array<U64, 64> king_attacks   = make_leaper_table(mask_king_attacks);
+
+    // Fancy magics: each square owns 2^relevant_bits consecutive entries of one shared
+    // table, rooks first (102400 entries) then bishops (5248), instead of padding every
+    // square to the worst case
+    struct Magic {
+        U64      mask;      // relevant occupancy
+        U64      magic;
+        unsigned offset;    // first entry of this square in slider_attacks / slider_attacks_pext
+        unsigned shift;     // 64 - relevant bits
+    };
+
+    inline constexpr int rook_table_size   = 102400;
+    inline constexpr int bishop_table_size = 5248;
+    inline constexpr int slider_table_size = rook_table_size + bishop_table_size;
+
+    // Slider tables are constexpr too, but defined in Attacks.cpp only: evaluating them
+    // takes seconds, which every including translation unit would otherwise pay
+    extern const std::array<Magic, 64> bishop_magics;
+    extern const std::array<Magic, 64> rook_magics;
+
+    // slider attack sets indexed by the magic product, and by pext(occupancy, mask)
+    extern const std::array<U64, slider_table_size> slider_attacks;
+    extern const std::array<U64, slider_table_size> slider_attacks_pext;
+
+    // slider backend: PEXT on CPUs with a fast BMI2 unit, magics otherwise (chosen by init_attacks)
+    extern bool use_pext;
+
+    // squares strictly between two aligned squares / the full line through them (0 if not aligned)
+    extern const std::array<std::array<U64, 64>, 64> between_bb;
+    extern const std::array<std::array<U64, 64>, 64> line_bb;
 
 
     // -----------------------
     // API
     // -----------------------
+    // all tables are built at compile time; this only selects the slider backend
     void init_attacks();
 
+    // BMI2 present / PEXT worth using (not on AMD before Zen 3, where it is microcoded)
+    bool cpu_has_bmi2();
+    bool cpu_has_fast_pext();
+
+    // parallel bit extract; the asm form needs no -mbmi2, so one binary serves both backends
+    inline U64 pext(U64 src, U64 mask) {
+    #if defined(__BMI2__)
+        return __builtin_ia32_pext_di(src, mask);
+    #elif defined(__x86_64__) && defined(__GNUC__)
+        U64 result;
+        asm("pextq %2, %1, %0" : "=r"(result) : "r"(src), "r"(mask));
+        return result;
+    #else
+        U64 result = 0;
+        for (U64 bit = 1; mask; bit <<= 1, mask &= mask - 1)
+            if (src & mask & -mask) result |= bit;
+        return result;
+    #endif
+    }
+
     inline U64 get_bishop_attacks(int square, U64 occupancy) {
-        occupancy &= bishop_masks[square];
-        occupancy *= bishop_magic_numbers[square];
-        occupancy >>= 64 - bishop_relevant_bits[square];
-        return bishop_attacks[square][occupancy];
+        const Magic& m = bishop_magics[square];
+        if (use_pext) return slider_attacks_pext[m.offset + pext(occupancy, m.mask)];
+        return slider_attacks[m.offset + (((occupancy & m.mask) * m.magic) >> m.shift)];
     }
 
     inline U64 get_rook_attacks(int square, U64 occupancy) {
-        occupancy &= rook_masks[square];
-        occupancy *= rook_magic_numbers[square];
-        occupancy >>= 64 - rook_relevant_bits[square];
-        return rook_attacks[square][occupancy];
+        const Magic& m = rook_magics[square];
+        if (use_pext) return slider_attacks_pext[m.offset + pext(occupancy, m.mask)];
+        return slider_attacks[m.offset + (((occupancy & m.mask) * m.magic) >> m.shift)];
     }
 
     inline U64 get_queen_attacks(int square, U64 occupancy) {
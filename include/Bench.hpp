@@ -0,0 +1,18 @@
+# pragma once
+# include "Common.hpp"
+# include <stddef.h>
+
+namespace bbc{
+
+    // bench defaults: search depth, hash per search thread (MB), threads
+    inline constexpr int BENCH_DEPTH   = 10;
+    inline constexpr int BENCH_HASH_MB = 16;
+    inline constexpr int BENCH_THREADS = 1;
+
+    // Search the built-in bench positions to a fixed depth and print total nodes, time and NPS.
+    // Every position starts from a cleared TT and search context, so the node count is a
+    // signature of the search that doesn't depend on the thread count (threads split the
+    // positions, each with its own hash_mb table, clamped to [1, MAX_HASH_MB]). Returns the
+    // total node count.
+    U64 bench(int depth = BENCH_DEPTH, int hash_mb = BENCH_HASH_MB, int threads = BENCH_THREADS);
+}
@@ -42,6 +42,14 @@ namespace bbc {
     };
     
 
+    // check and pin state of a position, refreshed by set_check_info after every move
+    struct CheckInfo {
+        U64 checkers;           // enemy pieces giving check to the side to move
+        U64 blockers[2];        // sole pieces (either color) between king c and an enemy slider
+        U64 pinners[2];         // sliders of color c holding a blocker against the enemy king
+        U64 check_squares[6];   // squares from which piece type P..K of the side to move gives check
+    };
+
     // chess board representation
     struct Board {
         Board();
@@ -50,6 +58,7 @@ namespace bbc {
         U64                     bitboards[12];
         U64                     occupancies[3];
         U64                     hash;
+        U64                     pawn_hash;     // pawn-only zobrist key (correction history)
         int                     side;
         int                     enpassant;
         int                     castle;
@@ -59,6 +68,7 @@ namespace bbc {
         // info optimizations
         int                     piece_at[64];
         int                     king_sq[2];
+        CheckInfo               check_info;
 
         // store previous positions for repetition detection
         U64                     rep_keys[1024];     // store hashes
@@ -91,6 +101,20 @@ namespace bbc {
         void print_board() const;
     };
 
+    // move details the 16-bit encoding leaves to the board; valid before the move is made
+    inline int get_move_piece(const Board& board, int move) {
+        return board.piece_at[get_move_source(move)];
+    }
+
+    inline bool get_move_capture(const Board& board, int move) {
+        return board.piece_at[get_move_target(move)] != no_piece || get_move_enpassant(move);
+    }
+
+    // promoted piece in the mover's color, 0 if the move is no promotion
+    inline int get_move_promoted(const Board& board, int move) {
+        return get_move_promotion(move) ? get_move_promoted_type(move) + (board.side == white ? 0 : 6) : 0;
+    }
+
     // info to restore position
     struct StateInfo {
         int old_castle;
@@ -102,6 +126,10 @@ namespace bbc {
 
         // hash
         U64 old_hash;
+        U64 old_pawn_hash;
+
+        // checkers, pins and check squares
+        CheckInfo old_check_info;
 
         // repetitions
         int      old_rep_len;
@@ -149,14 +177,43 @@ namespace bbc {
 
     inline void restore_copy( Board const& copy, Board& b)   {b = copy;}
 
-    // define hashing
-    extern U64 random_pieces[768];
-    extern U64 random_side;
-    extern U64 random_castling[16];
-    extern U64 random_file[8];
+    // define hashing: the keys are drawn at compile time from the xorshift64* in Common.hpp,
+    // in the order pieces, side, castling, file
+    struct ZobristKeys {
+        U64 pieces[768];
+        U64 side;
+        U64 castling[16];
+        U64 file[8];
+    };
+
+    constexpr ZobristKeys make_zobrist_keys() {
+        ZobristKeys keys{};
+        U64 state = zobrist_seed;
+        for (int i = 0; i < 768; i++) keys.pieces[i] = next_random_U64(state);
+        keys.side = next_random_U64(state);
+        for (int i = 0; i < 16; i++) keys.castling[i] = next_random_U64(state);
+        for (int i = 0; i < 8; i++) keys.file[i] = next_random_U64(state);
+        return keys;
+    }
 
-    // init random numbers
-    void init_zobrist_table();
+    inline constexpr ZobristKeys zobrist_keys = make_zobrist_keys();
+
+    inline constexpr const U64 (&random_pieces)[768]  = zobrist_keys.pieces;
+    inline constexpr const U64& random_side            = zobrist_keys.side;
+    inline constexpr const U64 (&random_castling)[16] = zobrist_keys.castling;
+    inline constexpr const U64 (&random_file)[8]      = zobrist_keys.file;
+
+    // fold of every Zobrist key, stamped into files of hashed data (hash files, experience):
+    // their keys are only valid for the keys they were computed with
+    constexpr U64 zobrist_checksum() {
+        U64 sum = 0;
+        auto mix = [&](U64 key){ sum = ((sum << 7) | (sum >> 57)) ^ key; };
+        for (U64 key : random_pieces)   mix(key);
+        mix(random_side);
+        for (U64 key : random_castling) mix(key);
+        for (U64 key : random_file)     mix(key);
+        return sum;
+    }
 
 }  // namespace bbc
 
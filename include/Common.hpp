@@ -140,16 +140,33 @@ namespace bbc {
     // pseudo random number state
     inline unsigned int random_state = 1804289383;
 
-    // generate 32-bit pseudo legal numbers
-    inline unsigned int get_random_U32_number()
+    // XOR shift step of the runtime generator below
+    constexpr unsigned int xorshift32(unsigned int number)
     {
-        // get current state
-        unsigned int number = random_state;
-        
-        // XOR shift algorithm
         number ^= number << 13;
         number ^= number >> 17;
         number ^= number << 5;
+        return number;
+    }
+
+    // xorshift64* generator for compile-time keys. Unlike the xorshift32 stream above, whose
+    // outputs all lie in a 32-dimensional GF(2) space (so xors of a few dozen keys collide),
+    // the final multiply makes the output nonlinear
+    inline constexpr U64 zobrist_seed = 1070372;
+
+    constexpr U64 next_random_U64(U64& state)
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+
+    // generate 32-bit pseudo legal numbers
+    inline unsigned int get_random_U32_number()
+    {
+        // XOR shift algorithm on the current state
+        unsigned int number = xorshift32(random_state);
         
         // update random number state
         random_state = number;
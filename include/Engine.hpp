@@ -1,5 +1,6 @@
 # pragma once
 # include "Common.hpp"
+# include "Move.hpp"
 # include <atomic>
 
 namespace bbc{
@@ -7,16 +8,37 @@ namespace bbc{
     const int MAX_KILL_STORED = 2;
     const bool DEBUG = false;
 
+    // correction history: entries per side, fixed-point grain, clamp
+    const int CORR_SIZE  = 16384;
+    const int CORR_GRAIN = 256;
+    const int CORR_MAX   = 64 * CORR_GRAIN;
+
     // search context with miscellaneous info
     struct SearchContext{
         U64 nodes = 0;
         
         // killer moves
-        int killerMoves[MAX_PLY][MAX_KILL_STORED] = {};
+        Move killerMoves[MAX_PLY][MAX_KILL_STORED] = {};
 
         // null pruning
         bool null_enabled = true;
 
+        // depth of the current iteration (bounds check extensions)
+        int root_depth = 0;
+
+        // deepest iteration the last search finished
+        int completed_depth = 0;
+
+        // UCI option "IID": shallow search instead of IIR when no hash move (kept by clear())
+        bool iid_enabled = false;
+
+        // no per-depth "info" lines, e.g. while benchmarking (kept by clear())
+        bool silent = false;
+
+        // pawn structure -> running average of (search score - static eval), scaled by
+        // CORR_GRAIN; learned across moves, so only clear_history() resets it
+        int16_t pawn_corr[2][CORR_SIZE] = {};
+
         // time management
         bool one_move = false;
         std::atomic<bool> stop{false};
@@ -25,17 +47,22 @@ namespace bbc{
         U64 start = 0;
 
         void clear();
+        void clear_history();
     };
 
 
     // time management/context
-    inline constexpr long OVERHEAD = 50; // 50ms overhead
+    inline constexpr long OVERHEAD = 50; // default move overhead in ms (UCI option MoveOverhead)
+    inline constexpr long MIN_BUDGET = 10; // ms: shortest soft/hard limit, however little time is left
 
     struct TimeContext{
-        U64 ms_left;
-        U64 ms_inc;
-        U64 start;
-        U64 limit;
+        U64 ms_left = 0;
+        U64 ms_inc = 0;
+        U64 start = 0;
+        U64 limit = 0;
+
+        // time kept back per move for GUI/network lag (UCI option MoveOverhead, kept by clear())
+        long overhead = OVERHEAD;
 
         void clear();
     };
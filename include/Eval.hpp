@@ -112,7 +112,7 @@ inline bool is_threefold(const Board& b) {
 // store value
 struct move_utility {
     int utility;
-    int move;
+    Move move;
 };
 
 }
\ No newline at end of file
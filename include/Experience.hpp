@@ -0,0 +1,58 @@
+# pragma once
+# include "Common.hpp"
+# include "Board.hpp"
+# include "Move.hpp"
+# include "TT.hpp"
+# include <cstdint>
+# include <cstdio>
+# include <string>
+# include <unordered_map>
+
+namespace bbc{
+
+    // root searches shallower than this are not worth remembering
+    inline constexpr int EXPERIENCE_MIN_DEPTH = 12;
+
+    // one root search result, as stored in the file (16 bytes)
+    struct ExperienceRecord {
+        U64 key = 0;
+        Move move = 0;
+        int16_t score = 0;
+        int16_t depth = 0;
+        uint16_t reserved = 0;
+    };
+
+    // Append-only file of root search results keyed by Zobrist hash (UCI option Experience).
+    // The file is mapped once when opened and indexed in memory, keeping the deepest record per
+    // position; a search that goes deeper than what is known appends one record. Several
+    // engines may append to the same file, but compact while none of them is running.
+    class Experience {
+    public:
+        Experience() = default;
+        Experience(const Experience&) = delete;
+        Experience& operator=(const Experience&) = delete;
+        ~Experience();
+
+        // open the file at path, creating it if needed; an empty path closes it. On failure
+        // the file open before stays open
+        bool open(const std::string& path);
+        void close();
+        inline bool is_open() const { return file != nullptr; }
+
+        // store what is known about board and the positions one legal move away into tt as
+        // exact entries; returns how many were stored
+        int inject(Board& board, TranspositionTable& tt) const;
+
+        // append the result of a root search of board if it beats the known depth
+        void record(const Board& board, Move move, int score, int depth);
+
+        // rewrite the file with one record per position, dropping the superseded ones
+        bool compact();
+
+    private:
+        std::FILE* file = nullptr;      // opened for appending
+        std::string path{};
+        std::unordered_map<U64, ExperienceRecord> index{};
+        size_t records = 0;             // in the file, superseded ones included
+    };
+}
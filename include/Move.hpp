@@ -4,49 +4,50 @@
 
 namespace bbc{
 // -----------------------------
-// Move encoding
+// Move encoding (16 bits)
 // -----------------------------
-inline constexpr int encode_move(
-    int source, int target, int piece, int promoted,
-    bool capture, bool double_push, bool enpassant, bool castling) noexcept
+//   bits  0-5   source square
+//   bits  6-11  target square
+//   bits 12-13  promotion piece (knight, bishop, rook, queen)
+//   bits 14-15  special: normal, promotion, en-passant, castling
+// The moved and captured pieces are not stored: read them from the board (see Board.hpp)
+using Move = uint16_t;
+
+enum { move_normal = 0, move_promotion = 1 << 14, move_enpassant = 2 << 14, move_castling = 3 << 14 };
+
+// promoted: piece code of either color (N..Q or n..q), only read for move_promotion
+inline constexpr Move encode_move(int source, int target, int type = move_normal, int promoted = N) noexcept
 {
-    return  (int(source)   & 0x3f) |
-           ((int(target)   & 0x3f) << 6)  |
-           ((int(piece)    & 0x0f) << 12) |
-           ((int(promoted) & 0x0f) << 16) |
-           ((capture      ? 1u : 0u) << 20) |
-           ((double_push  ? 1u : 0u) << 21) |
-           ((enpassant    ? 1u : 0u) << 22) |
-           ((castling     ? 1u : 0u) << 23);
+    return Move((source & 0x3f) | ((target & 0x3f) << 6) | (((promoted % 6) - N) << 12) | type);
 }
 
-inline constexpr int  get_move_source(int m)     noexcept { return  (m & 0x3f); }
-inline constexpr int  get_move_target(int m)     noexcept { return ((m >> 6) & 0x3f); }
-inline constexpr int  get_move_piece(int m)      noexcept { return ((m >> 12) & 0xf); }
-inline constexpr int  get_move_promoted(int m)   noexcept { return ((m >> 16) & 0xf); }
-inline constexpr bool get_move_capture(int m)    noexcept { return  m & 0x100000; }
-inline constexpr bool get_move_double(int m)     noexcept { return  m & 0x200000; }
-inline constexpr bool get_move_enpassant(int m)  noexcept { return  m & 0x400000; }
-inline constexpr bool get_move_castling(int m)   noexcept { return  m & 0x800000; }
+inline constexpr int  get_move_source(int m)        noexcept { return  (m & 0x3f); }
+inline constexpr int  get_move_target(int m)        noexcept { return ((m >> 6) & 0x3f); }
+inline constexpr int  get_move_type(int m)          noexcept { return  (m & 0xc000); }
+inline constexpr bool get_move_promotion(int m)     noexcept { return get_move_type(m) == move_promotion; }
+inline constexpr bool get_move_enpassant(int m)     noexcept { return get_move_type(m) == move_enpassant; }
+inline constexpr bool get_move_castling(int m)      noexcept { return get_move_type(m) == move_castling; }
+
+// promoted piece as a white piece code (N..Q), 0 if the move is no promotion
+inline constexpr int  get_move_promoted_type(int m) noexcept { return get_move_promotion(m) ? ((m >> 12) & 3) + N : 0; }
 
 // -----------------------------
 // Move container
 // -----------------------------
 struct MoveList{
-    int moves[256];
-    int scores[256];
-    int count;
+    Move moves[256];
+    int count = 0;
 };
 
 // Add one encoded move into the list
-void add_move(MoveList& list, int move);
+inline void add_move(MoveList& list, Move move) { list.moves[list.count++] = move; }
 
 // -----------------------------
 // Printing / debugging
 // -----------------------------
 void print_move(int move);
 std::string move_string(int move);
-void print_move_list(MoveList& list);
+void print_move_list(const MoveList& list);
 
 // -----------------------------
 // Debug list compare helpers
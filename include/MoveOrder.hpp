@@ -24,7 +24,7 @@ namespace bbc{
         {10, 11, 12, 13, 14, 15, 10, 11, 12, 13, 14, 15},
     };
 
-    void storeKillerMove(int move, int ply, SearchContext& sc);
+    void storeKillerMove(int move, const Board& board, SearchContext& sc);
 
     // assign score weightings
     inline constexpr int TT_SCORE = 10000;
@@ -25,8 +25,27 @@ bool in_check_now(const Board& b);
 
 bool has_legal_move(const Board & b);
 
-// generate pseudo-legal moves for current global `side`
-void generate_moves(MoveList& list, Board& b, bool quiet=true);
+// What generate<Type> produces. Every mode yields legal moves only.
+//   gen_captures     captures and queen promotions        (side to move not in check)
+//   gen_quiets       non-captures, castling, underpromotions (not in check)
+//   gen_quiet_checks non-capturing, non-promoting moves that give check (not in check)
+//   gen_evasions     all moves out of check                (side to move in check)
+//   gen_non_evasions gen_captures + gen_quiets             (not in check)
+enum GenType { gen_captures, gen_quiets, gen_quiet_checks, gen_evasions, gen_non_evasions };
+
+// append moves of the given GenType for the side to move
+template<int Type>
+void generate(MoveList& list, const Board& b);
+
+// generate all legal moves for the side to move
+void generate_moves(MoveList& list, const Board& b);
+
+// Dedicated generators; they append to the list, so stages can share one MoveList.
+// captures, quiets and quiet checks expect the side to move not to be in check.
+void generate_captures(MoveList& list, const Board& b);     // captures + queen promotions
+void generate_quiets(MoveList& list, const Board& b);       // quiets, castling, underpromotions
+void generate_evasions(MoveList& list, const Board& b);     // king moves, blocks and captures of the checker
+void generate_quiet_checks(MoveList& list, const Board& b); // non-capturing checks (no king moves)
 
 
 } // end namespace bbc
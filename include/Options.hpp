@@ -0,0 +1,60 @@
+# pragma once
+# include <functional>
+# include <string>
+# include <vector>
+
+namespace bbc{
+
+    // net loaded at startup (UCI option EvalFile)
+    inline constexpr const char* DEFAULT_EVAL_FILE = "src/nn-eba324f53044.nnue";
+
+    // UCI option types
+    enum { option_check, option_spin, option_string };
+
+    struct Option;
+
+    // applies a new value; false rejects it (setoption then restores the previous value)
+    using OptionHandler = std::function<bool(const Option&)>;
+
+    struct Option {
+        std::string name{};
+        int type = option_check;
+        std::string default_value{};
+        std::string value{};
+        int min = 0;    // spin bounds
+        int max = 0;
+
+        // called after a successful setoption
+        OptionHandler on_change{};
+
+        inline int  as_int()  const { return std::stoi(value); }
+        inline bool as_bool() const { return value == "true"; }
+    };
+
+    // typed option registry, printed in registration order
+    class OptionsMap {
+    public:
+        void add_check (const std::string& name, bool default_value,
+                        OptionHandler on_change = nullptr);
+        void add_spin  (const std::string& name, int default_value, int min, int max,
+                        OptionHandler on_change = nullptr);
+        void add_string(const std::string& name, const std::string& default_value,
+                        OptionHandler on_change = nullptr);
+
+        // "option name ... type ..." lines for the uci command
+        void print_uci() const;
+
+        // "setoption name <id> [value <x>]": validate, store and run the handler; prints an
+        // info string and returns false on an unknown name or an invalid value, and returns
+        // false keeping the previous value when the handler rejects it
+        bool setoption(const char* command);
+
+        // lookup by name (case insensitive, as in UCI), nullptr if unknown
+        const Option* find(const std::string& name) const;
+
+    private:
+        Option* find_mutable(const std::string& name);
+
+        std::vector<Option> options{};
+    };
+}
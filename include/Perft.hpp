@@ -91,61 +91,73 @@ inline U64 perft_driver_legal(Board& board, int depth)
 }
 
 
-// perft test
-inline uint64_t perft_test(Board& board, int depth)
+// gives_check validation: compare the predicate with make-and-test on every move of the
+// perft tree; returns the number of mismatches and counts the checking moves seen
+inline U64 gives_check_driver(Board& board, int depth, U64& checks)
 {
-    printf("\n     Performance test\n\n");
-    
-    // create move list instance
-    MoveList move_list;
-    
-    // generate moves
-    generate_moves(move_list, board);
+    if (depth == 0) return 0;
 
     StateInfo st;
-    
-    U64 nodes = 0;
+    U64 mismatches = 0;
+
+    MoveList move_list;
+    generate_moves(move_list, board);
 
-    // init start time
-    long start = get_time_ms();
-    
-    // loop over generated moves
     for (int move_count = 0; move_count < move_list.count; move_count++)
-    {   
-        // preserve board state
-        Board copy;
-        copy_board(copy, board);
-        
-        // make move
-        if (!make_move(move_list.moves[move_count], all_moves, board, st))
-            // skip to the next move
-            continue;
-        
-        // cummulative nodes
-        U64 cummulative_nodes = nodes;
-        
-        // call perft driver recursively
-        nodes += perft_driver(board, depth - 1);
-        
-        // old nodes
-        U64 old_nodes = nodes - cummulative_nodes;
-        
-        // take back
-        restore_copy(copy, board);
-        
-        // print move
-        printf("     move: %s%s%c  nodes: %ld\n", square_to_coordinates[get_move_source(move_list.moves[move_count])],
-                                                 square_to_coordinates[get_move_target(move_list.moves[move_count])],
-                                                 get_move_promoted(move_list.moves[move_count]) ? promoted_pieces[get_move_promoted(move_list.moves[move_count])] : ' ',
-                                                 old_nodes);
-    }
-    
-    // print results
-    printf("\n    Depth: %d\n", depth);
-    printf("    Nodes: %ld\n", nodes);
-    printf("     Time: %ld\n\n", get_time_ms() - start);
+    {
+        const int move = move_list.moves[move_count];
+        const bool predicted = gives_check(board, move);
 
-    return nodes;
+        make_move(move, all_moves, board, st);
+
+        const bool actual = in_check_now(board);
+        checks += actual;
+        if (predicted != actual) {
+            mismatches++;
+            printf("     gives_check mismatch: %s (predicted %d)\n", move_string(move).c_str(), predicted);
+        }
+        mismatches += gives_check_driver(board, depth - 1, checks);
+
+        undo_move(board, st, move);
+    }
+    return mismatches;
 }
 
+// -----------------------------
+// Parallel perft
+// -----------------------------
+// Root moves are split across a thread pool, each worker on its own copy of the board.
+// Depth 1 is bulk counted (the generator is legal, so the move count is the node count),
+// and with hash_mb > 0 subtree counts are cached by (hash, depth) in a shared table.
+struct PerftResult {
+    U64 nodes = 0;
+    MoveList root_moves{};      // legal root moves in generation order
+    U64 move_nodes[256] = {};   // nodes below each root move (divide)
+};
+
+PerftResult perft_parallel(const Board& board, int depth, int threads = 1, size_t hash_mb = 0);
+
+// perft with a per root move breakdown (divide), printed to stdout
+U64 perft_test(const Board& board, int depth, int threads = 1, size_t hash_mb = 0);
+
+// -----------------------------
+// Perft drivers and suite
+// -----------------------------
+enum {
+    perft_bulk,     // parallel, bulk counting at depth 1
+    perft_hash,     // perft_bulk plus the perft hash table
+    perft_make,     // perft_driver: single thread, make/undo down to the leaves
+    perft_legal     // perft_driver_legal: perft_make with make_move_legal
+};
+
+// driver by name ("bulk", "hash", "make", "legal"), -1 if unknown
+int parse_perft_driver(const char* name);
+
+// node count of board at depth with the given driver (threads only used by bulk / hash)
+U64 perft_run(const Board& board, int depth, int driver, int threads);
+
+// run the built-in positions with known node counts, print pass/fail and NPS per position;
+// returns true if every count matched
+bool perft_suite(int driver, int threads);
+
 }
\ No newline at end of file
@@ -20,19 +20,46 @@ inline constexpr int castling_rights[64] = {
     13, 15, 15, 15, 12, 15, 15, 14
 };
 
+// piece values used by static exchange evaluation and delta pruning
+inline constexpr int see_values[12] = {
+    100, 320, 330, 500, 900, 20000,
+    100, 320, 330, 500, 900, 20000
+};
+
 // return 1 if square is attacked by side_, otherwise 0
 int is_square_attacked(const Board& board, int square, int side_);
 
+// all pieces (both colors) attacking square with the given occupancy
+U64 attackers_to(const Board& board, int square, U64 occupied);
+
+// static exchange evaluation: true if move wins at least threshold material
+bool see_ge(const Board& board, int move, int threshold);
+
+// attack test with a custom occupancy; the piece on removed_sq (a capture) no longer attacks
+int is_square_attacked_occ(const Board& board, int square, int attacker_side,
+                           U64 occupied, int removed_sq = no_sq);
 
-static inline int is_square_attacked_occ(const Board& board, int square, int attacker_side,
-                                         U64 occupied, int removed_sq = no_sq);
+// pieces (either color) that are the only blocker between ksq and a slider of attacker_side;
+// own blockers of the king's side are pinned, the mover's own are discovered-check candidates.
+// Sliders pinning a piece of the king's color are added to pinners.
+U64 slider_blockers(const Board& board, int ksq, int attacker_side, U64& pinners);
+
+// recompute board.check_info (checkers, blockers/pinners, check squares) for the side to move
+void set_check_info(Board& board);
+
+// true if the legal move checks the enemy king (direct, discovered, promotion, en-passant, castling)
+bool gives_check(const Board& board, int move);
+
+// hash after the move without making it (TT prefetch); make_move asserts they agree
+U64 key_after(const Board& board, int move);
 
 // Assumes move is pseudo-legal.
 // Returns 1 if legal, 0 if illegal.
 int check_legal(const Board& board, int move);
 
 // Make a move; if move_flag==all_moves, try any; if only_captures, reject non-captures.
-// returns 1 if legal (applied), 0 if illegal (board restored).
+// Moves come from the legal generator, so no legality test is done: returns 1 if applied,
+// 0 if rejected by move_flag.
 
 // make_move with efficient updates
 int make_move(int move, int move_flag, Board& b, StateInfo& st);
@@ -43,6 +70,10 @@ void undo_move(Board& b, const StateInfo& st, const int move);
 // testing functions
 int make_move_legal(int move, int move_flag, Board& b, StateInfo& st);
 
+// true if the side to move has a reversible move reaching a position already on the
+// board history (cuckoo lookup of key differences); ply is the distance from the search root
+bool upcoming_repetition(const Board& board, int ply);
+
 // null moves
 void make_null_move(Board& board, StateInfo& st);
 
@@ -21,11 +21,29 @@
 
 namespace bbc{
 
-    // q search at terminal depths (d=0)
-    int qsearch(int alpha, int beta, Board& board, TranspositionTable& tt, SearchContext& sc);
+    // qsearch: skip captures that cannot reach alpha even winning the victim plus this margin
+    inline constexpr int DELTA_MARGIN = 200;
 
-    // search at given depth d, using a null window (pvNode)
-    move_utility negamax(int alpha, int beta, int depth, Board& board, TranspositionTable& tt, SearchContext& sc, bool pvNode);
+    // singular extensions: minimum depth, and margin (cp per ply) below the TT score
+    inline constexpr int SINGULAR_DEPTH  = 6;
+    inline constexpr int SINGULAR_MARGIN = 2;
+
+    // internal iterative reductions: min depth; IID option searches this much shallower instead
+    inline constexpr int IIR_DEPTH     = 4;
+    inline constexpr int IID_REDUCTION = 2;
+
+    // probcut: min depth, margin above beta, and depth reduction of the verification search
+    inline constexpr int PROBCUT_DEPTH     = 5;
+    inline constexpr int PROBCUT_MARGIN    = 200;
+    inline constexpr int PROBCUT_REDUCTION = 4;
+
+    // q search at terminal depths (d=0); qply counts plies into qsearch, quiet checks are tried at qply 0
+    int qsearch(int alpha, int beta, Board& board, TranspositionTable& tt, SearchContext& sc, int qply = 0);
+
+    // search at given depth d, using a null window (pvNode); cutNode marks expected fail-highs,
+    // excluded move is skipped (singular verification)
+    move_utility negamax(int alpha, int beta, int depth, Board& board, TranspositionTable& tt, SearchContext& sc,
+                         bool pvNode, bool cutNode = false, int excluded = 0);
 
     // search in consecutive depths (1->2->...d)
     move_utility iterative_deepening(int depth, TimeContext& tc, Board& board, TranspositionTable& tt, SearchContext& sc);
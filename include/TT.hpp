@@ -1,21 +1,54 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <stddef.h>
+#include <string>
 
 #include "Common.hpp"
 #include "Board.hpp"
+#include "Move.hpp"
 
 namespace bbc{
 
 // table entry types
 enum {LOWER_BOUND, EXACT, UPPER_BOUND};
 
+// largest table size accepted from the user (UCI option Hash, bench), in MB
+inline constexpr int MAX_HASH_MB = 1048576;
+
+// fields of an entry, as returned by probe: scores fit in int16_t (|value| <= INF), depths in int16_t
 struct TTEntry {
     U64 key = 0;
-    int move = 0;
-    int depth = 0;
-    int value = 0;
-    int node_type = 0; // EXACT / LOWER / UPPER
+    Move move = 0;
+    int16_t value = 0;
+    int16_t depth = 0;
+    uint8_t node_type = 0; // EXACT / LOWER / UPPER
+    uint8_t generation = 0; // search that last stored or hit the entry
+};
+
+// an entry as stored, 16 bytes: data packs the fields and key holds hash ^ data. Both words are
+// read and written separately without locks, so a slot torn by two concurrent stores (threads,
+// or processes sharing the table) fails the key check instead of mixing two positions' fields
+struct TTSlot {
+    U64 key = 0;
+    U64 data = 0;
+};
+
+// counters of the current search. They are bumped with a relaxed load and store instead of an
+// atomic add: no data race and no locked instruction per probe, at the price of a lost count
+// when two threads hit the same counter at once
+struct TTStats {
+    std::atomic<U64> probes{0};
+    std::atomic<U64> hits{0};
+    std::atomic<U64> cutoffs{0};
+    std::atomic<U64> stores{0};
+    std::atomic<U64> replaced{0};       // evicted another position
+    std::atomic<U64> overwritten{0};    // updated the same position
+    std::atomic<U64> kept{0};           // existing entry was worth more, store dropped
+
+    static inline void bump(std::atomic<U64>& c) { c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+    void clear();
 };
 
 // define object class
@@ -23,24 +56,66 @@ class TranspositionTable {
 public:
     TranspositionTable(size_t mb = 64);
 
-    void resize(size_t mb);
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // reallocate for mb megabytes (power-of-two entry count); the contents are discarded. If the
+    // memory isn't available, or the table is shared, the current table is kept and false returned
+    bool resize(size_t mb);
 
+    // zero all entries, split across the engine thread pool. A shared table is left alone:
+    // the other processes attached to it are still using the entries
     void clear();
 
+    // back the table by the named shared memory segment, created with the current size by the
+    // first process and attached at its size by the others. An empty name goes back to a
+    // private table of the same size
+    bool share(const std::string& name);
+
+    // start loading the entry for key into cache (e.g. the child's key before make_move)
+    inline void prefetch(U64 key) const { __builtin_prefetch(&table[key & (size - 1)]); }
+
     bool probe(U64 key, TTEntry& out, int depth);
     void store(U64 key, int move, int depth, int utility, int node_type);
+
+    // count a probe that ended the node (TT cutoff)
     void inc_used();
+
+    // start a search: next generation, statistics reset
+    void new_search();
+
+    // permille of the first 1000 entries in use (by the current search only if current_only)
+    int hashfull(bool current_only = true) const;
+
+    // "info string" summary of the current search: hit and cutoff rates, store outcomes,
+    // occupancy and the share of entries from this search
+    void report() const;
+
+    // write the table to path behind a header (format version, entry count, Zobrist checksum)
+    bool save(const char* path) const;
+
+    // map a file written by save, verify its header and copy it in (taking its size, which a
+    // shared table requires to match)
+    bool load(const char* path);
+
     inline size_t getSize() const {return size;}
     ~TranspositionTable();
 
 private:
-    TTEntry* table;
-    size_t size;
-    
-    size_t probed;
-    size_t invalid_table_moves;
-    size_t stored;
-    size_t used;
+    bool allocate(size_t num_entries);
+    void release();
+    void for_each_slice(const std::function<void(size_t start, size_t count)>& fn);
+
+    TTSlot* table = nullptr;    // 2 MB aligned, huge pages where available (see large_alloc)
+    size_t size = 0;
+    int huge = 0;
+
+    void* segment = nullptr;    // shared mapping (header, then the table) or nullptr if private
+    size_t segment_bytes = 0;
+    std::string segment_name;
+
+    uint8_t generation = 0;
+    TTStats stats;
 };
 
 
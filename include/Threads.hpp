@@ -0,0 +1,54 @@
+# pragma once
+# include <atomic>
+# include <condition_variable>
+# include <functional>
+# include <mutex>
+# include <thread>
+# include <vector>
+
+namespace bbc{
+
+// fixed set of worker threads that split an indexed batch of tasks between them
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads = 1);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    inline int size() const { return int(workers.size()); }
+
+    // join the current workers and start `threads` new ones (no batch may be running)
+    void resize(int threads);
+
+    // call task(index, worker) for every index in [0, count), each worker pulling the next
+    // free index; returns once the whole batch is done. Batches from several callers run one
+    // after another, so a task must not start a batch on its own pool
+    void run(int count, const std::function<void(int, int)>& task);
+
+private:
+    void start_workers(int threads);
+    void stop_workers();
+    void worker_loop(int id, unsigned seen);
+
+    std::vector<std::thread> workers;
+    std::mutex run_mtx;     // one batch at a time
+    std::mutex mtx;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+
+    // current batch
+    const std::function<void(int, int)>* job = nullptr;
+    std::atomic<int> next{0};
+    int job_count = 0;
+    int busy = 0;
+    unsigned generation = 0;
+    bool quit = false;
+};
+
+// engine-wide pool, sized by the UCI option Threads: it runs helper work (TT clear and load,
+// perft); the search itself is single-threaded
+extern ThreadPool thread_pool;
+
+}
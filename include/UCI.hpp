@@ -4,6 +4,8 @@
 # include "TT.hpp"
 # include "MoveOrder.hpp"
 # include "Engine.hpp"
+# include "Options.hpp"
+# include "Experience.hpp"
 
 #include<iostream>
 #include<iomanip>
@@ -55,14 +57,20 @@ void parse_position(char *command, Board& board);
 */
 
 // parse UCI "go" command
-void parse_go(char *command, Board& board, TimeContext& tc, TranspositionTable& tt, SearchContext& sc);
+// (seeding the TT from the experience file first and recording the result in it afterwards)
+void parse_go(char *command, Board& board, TimeContext& tc, TranspositionTable& tt, SearchContext& sc, Experience& exp);
 
 /*
     GUI -> isready
     Engine -> readyok
     GUI -> uci
 */
-void uci_loop(Board& board, TimeContext& tc, TranspositionTable& tt, SearchContext& sc);
+void uci_loop(Board& board, TimeContext& tc, TranspositionTable& tt, SearchContext& sc, OptionsMap& options, Experience& exp);
+
+// register the UCI options (Hash, SharedHash, Threads, EvalFile, MoveOverhead, UseNNUE, IID,
+// Experience) with handlers acting on the engine state
+void init_options(OptionsMap& options, Board& board, TimeContext& tc, TranspositionTable& tt, SearchContext& sc,
+                  Experience& exp);
 
 
 }
\ No newline at end of file
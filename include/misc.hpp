@@ -37,6 +37,19 @@ size_t file_size(FD fd);
 const void *map_file(FD fd, map_t *map);
 void unmap_file(const void *data, map_t map);
 
+// 2 MB aligned allocation for large tables: explicit huge pages (MAP_HUGETLB) when the
+// system has them reserved, else aligned memory advised for transparent huge pages.
+// *huge records which one, for large_free. The memory is not zeroed.
+void *large_alloc(size_t size, int *huge);
+void large_free(void *mem, size_t size, int huge);
+
+// map the named POSIX shared memory segment read-write, creating it with *size bytes if it
+// does not exist yet; *size is set to the size of an existing one. init runs on a new segment
+// while an exclusive lock on it is held, and attaching takes the same lock, so no process
+// sees a half-initialised segment. Returns NULL on failure (and always on Windows)
+void *shm_attach(const char *name, size_t *size, void (*init)(void *mem, size_t size));
+void shm_detach(void *mem, size_t size);
+
 INLINE uint32_t readu_le_u32(const void *p)
 {
   const uint8_t *q = (const uint8_t*) p;
@@ -24,7 +24,7 @@
 
 // The original nnue probe API (C linkage)
 extern "C" {
-  void nnue_init(const char* evalFile);
+  int  nnue_init(const char* evalFile);
   int  nnue_evaluate(int player, int* pieces, int* squares);
   int  nnue_evaluate_fen(const char* fen);
 }
@@ -38,7 +38,7 @@ namespace bbc {
 namespace nnue {
  
   // Defined in nnue_bbc.cpp
-  void init(const char* path);
+  bool init(const char* path);
   bool loaded();
   int  evaluate_fen(const char* fen);
  
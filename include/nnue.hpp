@@ -96,7 +96,7 @@ int nnue_evaluate_pos(Board& board);
 extern "C" {
 #endif
 
-void nnue_init(
+int nnue_init(
   const char * evalFile             /** Path to NNUE file */
 );
 
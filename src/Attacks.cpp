@@ -1,69 +1,18 @@
 #include "Attacks.hpp"
 #include "Common.hpp"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#  include <cpuid.h>
+#endif
+
 namespace bbc {
     
-// ------------------
-// Table definitions
-// ------------------
-U64 pawn_attacks[2][64];
-U64 knight_attacks[64];
-U64 king_attacks[64];
-U64 bishop_masks[64];
-U64 rook_masks[64];
-U64 bishop_attacks[64][512];
-U64 rook_attacks[64][4096];
+bool use_pext = false;
 
 // ------------------
 // Attack masking
 // ------------------
-static U64 mask_pawn_attacks(int side, int square) {
-    U64 attacks = 0ULL, bitboard = 0ULL;
-    set_bit(bitboard, square);
-
-    if (side == 0) { // white
-        if ((bitboard >> 7) & not_a_file) attacks |= (bitboard >> 7);
-        if ((bitboard >> 9) & not_h_file) attacks |= (bitboard >> 9);
-    } else { // black
-        if ((bitboard << 7) & not_h_file) attacks |= (bitboard << 7);
-        if ((bitboard << 9) & not_a_file) attacks |= (bitboard << 9);
-    }
-    return attacks;
-}
-
-static U64 mask_knight_attacks(int square) {
-    U64 attacks = 0ULL, bitboard = 0ULL;
-    set_bit(bitboard, square);
-
-    if ((bitboard >> 17) & not_h_file) attacks |= (bitboard >> 17);
-    if ((bitboard >> 15) & not_a_file) attacks |= (bitboard >> 15);
-    if ((bitboard >> 10) & not_hg_file) attacks |= (bitboard >> 10);
-    if ((bitboard >> 6)  & not_ab_file) attacks |= (bitboard >> 6);
-    if ((bitboard << 17) & not_a_file) attacks |= (bitboard << 17);
-    if ((bitboard << 15) & not_h_file) attacks |= (bitboard << 15);
-    if ((bitboard << 10) & not_ab_file) attacks |= (bitboard << 10);
-    if ((bitboard << 6)  & not_hg_file) attacks |= (bitboard << 6);
-
-    return attacks;
-}
-
-static U64 mask_king_attacks(int square) {
-    U64 attacks = 0ULL, bitboard = 0ULL;
-    set_bit(bitboard, square);
-
-    if (bitboard >> 8) attacks |= (bitboard >> 8);
-    if ((bitboard >> 9) & not_h_file) attacks |= (bitboard >> 9);
-    if ((bitboard >> 7) & not_a_file) attacks |= (bitboard >> 7);
-    if ((bitboard >> 1) & not_h_file) attacks |= (bitboard >> 1);
-    if (bitboard << 8) attacks |= (bitboard << 8);
-    if ((bitboard << 9) & not_a_file) attacks |= (bitboard << 9);
-    if ((bitboard << 7) & not_h_file) attacks |= (bitboard << 7);
-    if ((bitboard << 1) & not_a_file) attacks |= (bitboard << 1);
-
-    return attacks;
-}
-
-static U64 mask_bishop_attacks(int square) {
+static constexpr U64 mask_bishop_attacks(int square) {
     U64 attacks = 0ULL;
     int tr = square / 8, tf = square % 8;
 
@@ -75,7 +24,7 @@ static U64 mask_bishop_attacks(int square) {
     return attacks;
 }
 
-static U64 mask_rook_attacks(int square) {
+static constexpr U64 mask_rook_attacks(int square) {
     U64 attacks = 0ULL;
     int tr = square / 8, tf = square % 8;
 
@@ -90,7 +39,7 @@ static U64 mask_rook_attacks(int square) {
 // ------------------
 // Sliding attacks on the fly
 // ------------------
-static U64 bishop_attacks_otf(int square, U64 block) {
+static constexpr U64 bishop_attacks_otf(int square, U64 block) {
     U64 attacks = 0ULL;
     int tr = square / 8, tf = square % 8;
 
@@ -102,7 +51,7 @@ static U64 bishop_attacks_otf(int square, U64 block) {
     return attacks;
 }
 
-static U64 rook_attacks_otf(int square, U64 block) {
+static constexpr U64 rook_attacks_otf(int square, U64 block) {
     U64 attacks = 0ULL;
     int tr = square / 8, tf = square % 8;
 
@@ -115,58 +64,134 @@ static U64 rook_attacks_otf(int square, U64 block) {
 }
 
 // ------------------
-// Occupancy
+// Slider tables
 // ------------------
-static U64 set_occupancy(int index, int bits_in_mask, U64 attack_mask) {
-    U64 occupancy = 0ULL;
-    for (int count = 0; count < bits_in_mask; count++) {
-        int square = __builtin_ctzll(attack_mask);
-        pop_bit(attack_mask, square);
-        if (index & (1 << count)) occupancy |= (1ULL << square);
-    }
-    return occupancy;
+// total entries a piece needs when every square gets exactly 2^relevant_bits slots
+static constexpr int table_span(const int (&relevant_bits)[64]) {
+    int total = 0;
+    for (int square = 0; square < 64; square++) total += 1 << relevant_bits[square];
+    return total;
 }
+static_assert(table_span(rook_relevant_bits)   == rook_table_size);
+static_assert(table_span(bishop_relevant_bits) == bishop_table_size);
+
+static constexpr std::array<Magic, 64> make_magics(bool bishop) {
+    std::array<Magic, 64> magics{};
+    unsigned offset = bishop ? rook_table_size : 0;
 
-// ------------------
-// Init helpers
-// ------------------
-static void init_leapers() {
     for (int square = 0; square < 64; square++) {
-        pawn_attacks[0][square] = mask_pawn_attacks(0, square);
-        pawn_attacks[1][square] = mask_pawn_attacks(1, square);
-        knight_attacks[square]  = mask_knight_attacks(square);
-        king_attacks[square]    = mask_king_attacks(square);
+        Magic& m = magics[square];
+        m.mask   = bishop ? mask_bishop_attacks(square) : mask_rook_attacks(square);
+        m.magic  = bishop ? bishop_magic_numbers[square] : rook_magic_numbers[square];
+        m.shift  = 64 - (bishop ? bishop_relevant_bits[square] : rook_relevant_bits[square]);
+        m.offset = offset;
+        offset += 1u << (64 - m.shift);
     }
+    return magics;
 }
 
-static void init_sliders(int bishop) {
-    for (int square = 0; square < 64; square++) {
-        bishop_masks[square] = mask_bishop_attacks(square);
-        rook_masks[square]   = mask_rook_attacks(square);
-
-        U64 mask = bishop ? bishop_masks[square] : rook_masks[square];
-        int bits = __builtin_popcountll(mask);
-        int variations = 1 << bits;
-
-        for (int index = 0; index < variations; index++) {
-            U64 occ = set_occupancy(index, bits, mask);
-            int magic_index;
-            if (bishop) {
-                magic_index = (occ * bishop_magic_numbers[square]) >> (64 - bishop_relevant_bits[square]);
-                bishop_attacks[square][magic_index] = bishop_attacks_otf(square, occ);
-            } else {
-                magic_index = (occ * rook_magic_numbers[square]) >> (64 - rook_relevant_bits[square]);
-                rook_attacks[square][magic_index] = rook_attacks_otf(square, occ);
+constexpr std::array<Magic, 64> bishop_magics = make_magics(true);
+constexpr std::array<Magic, 64> rook_magics   = make_magics(false);
+
+struct SliderTables {
+    std::array<U64, slider_table_size> magic;
+    std::array<U64, slider_table_size> pext;
+};
+
+// Both tables in one pass, so each attack set is computed once. The carry-rippler
+// enumerates the subsets of a mask in pext order, so the pext index is just a counter.
+static constexpr SliderTables make_slider_tables() {
+    SliderTables tables{};
+
+    for (int bishop = 0; bishop < 2; bishop++) {
+        for (int square = 0; square < 64; square++) {
+            const Magic& m = bishop ? bishop_magics[square] : rook_magics[square];
+            U64 occ = 0ULL;
+            unsigned index = 0;
+            do {
+                U64 attacks = bishop ? bishop_attacks_otf(square, occ) : rook_attacks_otf(square, occ);
+                tables.magic[m.offset + ((occ * m.magic) >> m.shift)] = attacks;
+                tables.pext[m.offset + index++] = attacks;
+                occ = (occ - m.mask) & m.mask;
+            } while (occ);
+        }
+    }
+    return tables;
+}
+
+static constexpr SliderTables slider_tables = make_slider_tables();
+
+constexpr std::array<U64, slider_table_size> slider_attacks      = slider_tables.magic;
+constexpr std::array<U64, slider_table_size> slider_attacks_pext = slider_tables.pext;
+
+// ------------------
+// Lines
+// ------------------
+struct LineTables {
+    std::array<std::array<U64, 64>, 64> between;
+    std::array<std::array<U64, 64>, 64> line;
+};
+
+static constexpr LineTables make_lines() {
+    LineTables t{};
+    for (int s1 = 0; s1 < 64; s1++) {
+        for (int s2 = 0; s2 < 64; s2++) {
+            if (s1 == s2) continue;
+
+            const U64 ends = (1ULL << s1) | (1ULL << s2);
+
+            if (rook_attacks_otf(s1, 0ULL) & (1ULL << s2)) {
+                t.line[s1][s2]    = (rook_attacks_otf(s1, 0ULL) & rook_attacks_otf(s2, 0ULL)) | ends;
+                t.between[s1][s2] = rook_attacks_otf(s1, 1ULL << s2) & rook_attacks_otf(s2, 1ULL << s1);
+            }
+            else if (bishop_attacks_otf(s1, 0ULL) & (1ULL << s2)) {
+                t.line[s1][s2]    = (bishop_attacks_otf(s1, 0ULL) & bishop_attacks_otf(s2, 0ULL)) | ends;
+                t.between[s1][s2] = bishop_attacks_otf(s1, 1ULL << s2) & bishop_attacks_otf(s2, 1ULL << s1);
             }
         }
     }
+    return t;
+}
+
+static constexpr LineTables line_tables = make_lines();
+
+constexpr std::array<std::array<U64, 64>, 64> between_bb = line_tables.between;
+constexpr std::array<std::array<U64, 64>, 64> line_bb    = line_tables.line;
+
+// ------------------
+// CPU detection
+// ------------------
+bool cpu_has_bmi2() {
+#if defined(__x86_64__) && defined(__GNUC__)
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+    return ebx & (1u << 8);
+#else
+    return false;
+#endif
+}
+
+bool cpu_has_fast_pext() {
+#if defined(__x86_64__) && defined(__GNUC__)
+    if (!cpu_has_bmi2()) return false;
+
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    __get_cpuid(0, &eax, &ebx, &ecx, &edx);
+    const bool amd = ebx == 0x68747541 && edx == 0x69746e65 && ecx == 0x444d4163; // "AuthenticAMD"
+    if (!amd) return true;
+
+    // families before 0x19 (Zen 3) run pext in microcode, far slower than a magic lookup
+    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+    int family = (eax >> 8) & 0xf;
+    if (family == 0xf) family += (eax >> 20) & 0xff;
+    return family >= 0x19;
+#else
+    return false;
+#endif
 }
 
 void init_attacks() {
-    // fill rook_magic_numbers[] and bishop_magic_numbers[] with your baked values
-    init_leapers();
-    init_sliders(rook);
-    init_sliders(bishop);
+    use_pext = cpu_has_fast_pext();
 }
 
 } // namespace bbc
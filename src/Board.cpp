@@ -2,6 +2,7 @@
 #include <iostream>
 #include <cstring>        
 #include "Board.hpp"
+#include "Position.hpp"
 
 namespace bbc {
     // DEBUG
@@ -17,6 +18,8 @@ namespace bbc {
         ply(0),
         fifty(0),
         hash(0),
+        pawn_hash(0),
+        check_info(),
         rep_len(0),
         rep_start(0),
         use_nnue(true),
@@ -163,6 +166,9 @@ namespace bbc {
         // set hash
         calc_hash();
 
+        // checkers, pins and check squares
+        set_check_info(*this);
+
         // store position in game history
         this->rep_len = 0;
         this->rep_start = 1;
@@ -252,6 +258,7 @@ namespace bbc {
     // get hash
     void Board::calc_hash() {
         this->hash = 0ULL;
+        this->pawn_hash = 0ULL;
         const auto& bitboards = this->bitboards;
         const auto& side = this->side;
         const auto& castle = this->castle;
@@ -292,6 +299,7 @@ namespace bbc {
     // ---- Hash  helpers ----
     void Board::xor_piece(int piece, int sq) {
         this->hash ^= random_pieces[piece * 64 + sq];
+        if (piece == P || piece == p) this->pawn_hash ^= random_pieces[piece * 64 + sq];
     }
 
 
@@ -303,25 +311,4 @@ namespace bbc {
         if (ep >= 16 && ep <= 23) this->hash ^= random_file[ep - 16];
         else if (ep >= 40 && ep <= 47) this->hash ^= random_file[ep - 40];
     }
-
-
-    // random pieces
-    U64 random_pieces[768];
-    U64 random_side;
-    U64 random_castling[16];
-    U64 random_file[8];
-
-    // init zobrist table
-    void init_zobrist_table(){
-        for(int i = 0; i < 768; i++){
-            random_pieces[i] = get_random_U64_number();
-        }
-        random_side = get_random_U64_number();
-        for(int i = 0; i < 16; i++){
-            random_castling[i] = get_random_U64_number();
-        }
-        for(int i = 0; i < 8; i++){
-            random_file[i] = get_random_U64_number();
-        }
-    }
 } // namespace bbc
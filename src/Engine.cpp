@@ -12,6 +12,8 @@ void SearchContext::clear(){
     }
 
     this->null_enabled = true;
+    this->root_depth = 0;
+    this->completed_depth = 0;
 
     this->one_move = false;
     this->stop.store(false, std::memory_order_relaxed);
@@ -20,6 +22,14 @@ void SearchContext::clear(){
     this->start = 0;
 }
 
+void SearchContext::clear_history(){
+    for(int side = 0; side < 2; side++){
+        for(int i = 0; i < CORR_SIZE; i++){
+            pawn_corr[side][i] = 0;
+        }
+    }
+}
+
 void TimeContext::clear(){
     this->ms_inc = 0;
     this->ms_left = 0;
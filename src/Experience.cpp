@@ -0,0 +1,228 @@
+# include "Experience.hpp"
+# include "Engine.hpp"
+# include "Movegen.hpp"
+# include "Position.hpp"
+# include "misc.hpp"
+# include <algorithm>
+# include <cstdlib>
+# include <cstring>
+# include <filesystem>
+# include <vector>
+
+namespace bbc{
+
+namespace {
+
+// bump when ExperienceRecord or the header changes
+constexpr uint32_t EXP_FILE_VERSION = 1;
+constexpr char EXP_FILE_MAGIC[8] = {'B', 'B', 'C', 'E', 'X', 'P', '\0', '\0'};
+
+struct ExpFileHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    U64      zobrist;       // checksum of the keys the records were hashed with
+    U64      reserved;
+};
+static_assert(sizeof(ExpFileHeader) == 32, "experience file header layout");
+static_assert(sizeof(ExperienceRecord) == 16, "experience record layout");
+
+ExpFileHeader make_header(){
+    ExpFileHeader header{};
+    std::memcpy(header.magic, EXP_FILE_MAGIC, sizeof(header.magic));
+    header.version     = EXP_FILE_VERSION;
+    header.record_size = sizeof(ExperienceRecord);
+    header.zobrist     = zobrist_checksum();
+    return header;
+}
+
+// the deepest record wins; on equal depth the later one, i.e. the more recent search
+void index_record(std::unordered_map<U64, ExperienceRecord>& index, const ExperienceRecord& rec){
+    auto it = index.find(rec.key);
+    if(it == index.end()) index.emplace(rec.key, rec);
+    else if(rec.depth >= it->second.depth) it->second = rec;
+}
+
+} // namespace
+
+Experience::~Experience(){
+    close();
+}
+
+void Experience::close(){
+    if(file) std::fclose(file);
+    file = nullptr;
+    path.clear();
+    index.clear();
+    records = 0;
+}
+
+bool Experience::open(const std::string& new_path){
+    if(new_path.empty()){
+        close();
+        return true;
+    }
+
+    // read into locals: on failure the file open so far stays in use
+    std::unordered_map<U64, ExperienceRecord> new_index;
+    size_t new_records = 0;
+    size_t bytes = 0;
+
+    FD fd = open_file(new_path.c_str());
+    if(fd != FD_ERR){
+        bytes = file_size(fd);
+        map_t mapping;
+        const void* data = bytes >= sizeof(ExpFileHeader) ? map_file(fd, &mapping) : nullptr;
+        close_file(fd);
+
+        if(bytes && !data){
+            std::printf("info string experience %s is not an experience file\n", new_path.c_str());
+            return false;
+        }
+
+        if(data){
+            ExpFileHeader header;
+            std::memcpy(&header, data, sizeof(header));
+
+            const char* error = nullptr;
+            if(std::memcmp(header.magic, EXP_FILE_MAGIC, sizeof(header.magic)) != 0) error = "not an experience file";
+            else if(header.version != EXP_FILE_VERSION || header.record_size != sizeof(ExperienceRecord)) error = "record format differs";
+            else if(header.zobrist != zobrist_checksum()) error = "hashed with different Zobrist keys";
+            if(error){
+                std::printf("info string experience %s: %s\n", new_path.c_str(), error);
+                unmap_file(data, mapping);
+                return false;
+            }
+
+            new_records = (bytes - sizeof(header)) / sizeof(ExperienceRecord);
+            const char* at = static_cast<const char*>(data) + sizeof(header);
+            for(size_t i = 0; i < new_records; i++, at += sizeof(ExperienceRecord)){
+                ExperienceRecord rec;
+                std::memcpy(&rec, at, sizeof(rec));
+                index_record(new_index, rec);
+            }
+            unmap_file(data, mapping);
+
+            // a record cut short by a crash: drop it so the appends stay aligned
+            const size_t whole = sizeof(header) + new_records * sizeof(ExperienceRecord);
+            if(bytes != whole){
+                std::error_code ec;
+                std::filesystem::resize_file(new_path, whole, ec);
+                bytes = whole;
+            }
+        }
+    }
+
+    std::FILE* new_file = std::fopen(new_path.c_str(), "ab");
+    if(!new_file){
+        std::printf("info string experience cannot open %s\n", new_path.c_str());
+        return false;
+    }
+    if(bytes == 0){
+        const ExpFileHeader header = make_header();
+        std::fwrite(&header, sizeof(header), 1, new_file);
+        std::fflush(new_file);
+    }
+
+    close();
+    file    = new_file;
+    path    = new_path;
+    index   = std::move(new_index);
+    records = new_records;
+
+    std::printf("info string experience %s records %zu positions %zu\n", path.c_str(), records, index.size());
+    return true;
+}
+
+int Experience::inject(Board& board, TranspositionTable& tt) const {
+    if(index.empty()) return 0;
+
+    int injected = 0;
+    auto seed = [&](U64 key){
+        auto it = index.find(key);
+        if(it == index.end()) return;
+        const ExperienceRecord& rec = it->second;
+        tt.store(key, rec.move, rec.depth, rec.score, EXACT);
+        injected++;
+    };
+
+    // the position, then its children: a reply found in the TT is searched from its record
+    seed(board.hash);
+
+    MoveList ml;
+    generate_moves(ml, board);
+    StateInfo st;
+    for(int i = 0; i < ml.count; i++){
+        const Move move = ml.moves[i];
+        if(!make_move(move, all_moves, board, st)) continue;
+        seed(board.hash);
+        undo_move(board, st, move);
+    }
+    return injected;
+}
+
+void Experience::record(const Board& board, Move move, int score, int depth){
+    // mate scores are distances from this root, which the TT does not adjust: keep them out
+    if(!file || !move || depth < EXPERIENCE_MIN_DEPTH || std::abs(score) >= MATE - MAX_PLY) return;
+
+    auto it = index.find(board.hash);
+    if(it != index.end() && it->second.depth >= depth) return;
+
+    ExperienceRecord rec;
+    rec.key   = board.hash;
+    rec.move  = move;
+    rec.score = int16_t(score);
+    rec.depth = int16_t(depth);
+
+    // one whole record per write, so engines appending to the same file don't interleave
+    if(std::fwrite(&rec, sizeof(rec), 1, file) != 1 || std::fflush(file) != 0){
+        std::printf("info string experience failed writing %s\n", path.c_str());
+        return;
+    }
+    index_record(index, rec);
+    records++;
+}
+
+bool Experience::compact(){
+    if(!file){
+        std::printf("info string experience: no file open\n");
+        return false;
+    }
+
+    // sorted by key, so compacting the same experience always gives the same file
+    std::vector<ExperienceRecord> kept;
+    kept.reserve(index.size());
+    for(const auto& [key, rec] : index) kept.push_back(rec);
+    std::sort(kept.begin(), kept.end(), [](const ExperienceRecord& a, const ExperienceRecord& b){ return a.key < b.key; });
+
+    // write beside the file, then swap it in: a failed compaction leaves the old file intact
+    const std::string tmp = path + ".tmp";
+    std::FILE* out = std::fopen(tmp.c_str(), "wb");
+    if(!out){
+        std::printf("info string experience cannot open %s\n", tmp.c_str());
+        return false;
+    }
+    const ExpFileHeader header = make_header();
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1
+           && std::fwrite(kept.data(), sizeof(ExperienceRecord), kept.size(), out) == kept.size();
+    ok = (std::fclose(out) == 0) && ok;
+
+    std::fclose(file);
+    file = nullptr;
+    if(ok) ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+    if(!ok) std::remove(tmp.c_str());
+
+    if(ok) std::printf("info string experience %s compacted %zu -> %zu records\n", path.c_str(), records, kept.size());
+    else   std::printf("info string experience failed compacting %s\n", path.c_str());
+    if(ok) records = kept.size();
+
+    file = std::fopen(path.c_str(), "ab");
+    if(!file){
+        std::printf("info string experience cannot reopen %s\n", path.c_str());
+        close();
+        return false;
+    }
+    return ok;
+}
+
+}
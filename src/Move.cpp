@@ -5,57 +5,31 @@
 
 namespace bbc{
 
-// -----------------------------
-// Add move
-// -----------------------------
-void add_move(MoveList& list, int move) {
-    list.moves[list.count++] = move;
-}
-
 // -----------------------------
 // Printing helpers
 // -----------------------------
 void print_move(int move) {
-    int promoted = get_move_promoted(move);
-    if(promoted==p)
-    std::printf("%s%s%c\n", square_to_coordinates[get_move_source(move)],
-                        square_to_coordinates[get_move_target(move)],
-                        promoted_pieces[get_move_promoted(move)]);
+    std::printf("%s\n", move_string(move).c_str());
 }
 
 std::string move_string(int move) {
     return std::string(square_to_coordinates[get_move_source(move)]) +
            std::string(square_to_coordinates[get_move_target(move)]) +
-           std::string(1, promoted_pieces[get_move_promoted(move)]);
+           std::string(1, promoted_pieces[get_move_promoted_type(move)]);
 }
 
-void print_move_list(MoveList& list) {
+void print_move_list(const MoveList& list) {
     if (!list.count) { std::printf("\n     No move in the move list!\n"); return; }
 
-    std::printf("\n     move    piece     capture   double    enpass    castling\n\n");
+    std::printf("\n     move    enpass    castling\n\n");
     for (int i = 0; i < list.count; ++i) {
         int m = list.moves[i];
-#ifdef WIN64
-        std::printf("      %s%s%c   %c         %d         %d         %d         %d\n",
-            square_to_coordinates[get_move_source(m)],
-            square_to_coordinates[get_move_target(m)],
-            get_move_promoted(m) ? promoted_pieces[get_move_promoted(m)] : ' ',
-            ascii_pieces[get_move_piece(m)],
-            get_move_capture(m) ? 1 : 0,
-            get_move_double(m) ? 1 : 0,
-            get_move_enpassant(m) ? 1 : 0,
-            get_move_castling(m) ? 1 : 0);
-#else
-        std::printf("     %s%s%c   %s         %d         %d         %d         %d\n",
+        std::printf("     %s%s%c   %d         %d\n",
             square_to_coordinates[get_move_source(m)],
             square_to_coordinates[get_move_target(m)],
-            get_move_promoted(m) ? promoted_pieces[get_move_promoted(m)] : ' ',
-            unicode_pieces[get_move_piece(m)],
-            get_move_capture(m) ? 1 : 0,
-            get_move_double(m) ? 1 : 0,
+            get_move_promotion(m) ? promoted_pieces[get_move_promoted_type(m)] : ' ',
             get_move_enpassant(m) ? 1 : 0,
             get_move_castling(m) ? 1 : 0);
-#endif
     }
     std::printf("\n\n     Total number of moves: %d\n\n", list.count);
 }
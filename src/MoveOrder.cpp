@@ -3,9 +3,11 @@
 
 namespace bbc{
     // store killer moves to a stack
-    void storeKillerMove(int move, int ply, SearchContext& sc){
+    void storeKillerMove(int move, const Board& board, SearchContext& sc){
+        const int ply = board.ply;
+
         // exit capture moves
-        if(get_move_capture(move)) return;
+        if(get_move_capture(board, move)) return;
 
         // exit if move exists alr
         if(move == sc.killerMoves[ply][0]) return;
@@ -31,9 +33,9 @@ namespace bbc{
                 scores[i].utility = TT_SCORE;
             }
             // 2: Capture moves
-            else if(get_move_capture(move)){
+            else if(get_move_capture(board, move)){
                 // Get mvv lva score
-                int piece = get_move_piece(move);
+                int piece = get_move_piece(board, move);
                 int target_sq = get_move_target(move);
 
                 int victim = board.piece_at[target_sq];
@@ -24,278 +24,315 @@ void print_attacked_squares(const Board& board, int side_) {
 
 // checkmate helpers
 bool in_check_now(const Board& board) {
-    return is_square_attacked(board, board.king_sq[board.side], board.side^1);
+    return board.check_info.checkers != 0;
 }
 
-bool has_legal_move(Board& board) {
+bool has_legal_move(const Board& board) {
     MoveList list; 
     generate_moves(list, board);
-    StateInfo st;
-    for (int i = 0; i < list.count; ++i) {
-        if (make_move(list.moves[i], all_moves, board, st)) {
-            // Proper undo that restores rep_len/rep_start as well
-            undo_move(board, st, list.moves[i]);
-            return true;
-        }
-        // if make_move failed it already restored
-    }
-    return false;
+    return list.count > 0;
 }
 
 // -----------------------------
-// Generate pseudo-legal moves
+// Generate legal moves
 // -----------------------------
+//
+// The generator is templated on the side to move and the GenType, so every color and
+// mode test below folds away at compile time. Checkers and pins are computed once per
+// call: in double check only king moves are generated, in single check other pieces
+// must capture or block the checker, and pinned pieces may only move along the line
+// through their king.
 
-// CHANGE TO STATE INFOOO AOSDOAOSD AS
-void generate_moves(MoveList& list, Board& board, bool quiet) {
-    // quiet -> promotions + captures
-    list.count = 0;
-    auto& bitboards = board.bitboards;
-    auto& side = board.side;
-    auto& occupancies = board.occupancies;
-    auto& enpassant = board.enpassant;
-    auto& castle = board.castle;
-
-    int source_square, target_square;
-    U64 bitboard, attacks;
-
-    for (int piece = P; piece <= k; ++piece) {
-        bitboard = bitboards[piece];
-
-        if (side == white) {
-            // White pawns
-            if (piece == P) {
-                while (bitboard) {
-                    source_square = __builtin_ctzll(bitboard);
-                    target_square = source_square - 8;
-
-                    // quiet pushes
-                    if (!(target_square < a8) && !get_bit(occupancies[both], target_square)) {
-                        // promotion
-                        if (source_square >= a7 && source_square <= h7) {
-                            add_move(list, encode_move(source_square, target_square, piece, Q, 0, 0, 0, 0));
-                            add_move(list, encode_move(source_square, target_square, piece, R, 0, 0, 0, 0));
-                            add_move(list, encode_move(source_square, target_square, piece, B, 0, 0, 0, 0));
-                            add_move(list, encode_move(source_square, target_square, piece, N, 0, 0, 0, 0));
-                        } 
-                        else if (quiet){
-                            add_move(list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                            if ((source_square >= a2 && source_square <= h2) && !get_bit(occupancies[both], target_square - 8))
-                                add_move(list, encode_move(source_square, target_square - 8, piece, 0, 0, 1, 0, 0));
-                        }
-                    }
-
-                    // captures
-                    attacks = pawn_attacks[side][source_square] & occupancies[black];
-                    while (attacks) {
-                        target_square = __builtin_ctzll(attacks);
-                        if (source_square >= a7 && source_square <= h7) {
-                            add_move(list, encode_move(source_square, target_square, piece, Q, 1, 0, 0, 0));
-                            add_move(list, encode_move(source_square, target_square, piece, R, 1, 0, 0, 0));
-                            add_move(list, encode_move(source_square, target_square, piece, B, 1, 0, 0, 0));
-                            add_move(list, encode_move(source_square, target_square, piece, N, 1, 0, 0, 0));
-                        } else {
-                            add_move(list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                        }
-                        pop_bit(attacks, target_square);
-                    }
-
-                    // en-passant
-                    if (enpassant != no_sq) {
-                        U64 ep = pawn_attacks[side][source_square] & (1ULL << enpassant);
-                        if (ep) {
-                            int t = __builtin_ctzll(ep);
-                            add_move(list, encode_move(source_square, t, piece, 0, 1, 0, 1, 0));
-                        }
-                    }
-
-                    pop_bit(bitboard, source_square);
-                }
-            }
+namespace {
 
-            // White castling (handled while scanning K)
-            if (piece == K) {
-                if ( castle & wk) {
-                    if (!get_bit(occupancies[both], f1) && !get_bit(occupancies[both], g1)) {
-                        if (!is_square_attacked(board, e1, black) && !is_square_attacked(board,f1, black))
-                            add_move(list, encode_move(e1, g1, piece, 0, 0, 0, 0, 1));
-                    }
-                }
-                if (castle & wq) {
-                    if (!get_bit(occupancies[both], d1) && !get_bit(occupancies[both], c1) && !get_bit(occupancies[both], b1)) {
-                        if (!is_square_attacked(board, e1, black) && !is_square_attacked(board, d1, black))
-                            add_move(list, encode_move(e1, c1, piece, 0, 0, 0, 0, 1));
-                    }
-                }
-            }
-        } else {
-            // Black pawns
-            if (piece == p) {
-                while (bitboard) {
-                    source_square = __builtin_ctzll(bitboard);
-                    target_square = source_square + 8;
-
-                    // quiet pushes
-                    if (!(target_square > h1) && !get_bit(occupancies[both], target_square)) {
-                        // promotion
-                        if (source_square >= a2 && source_square <= h2) {
-                            add_move(list, encode_move(source_square, target_square, piece, q, 0, 0, 0, 0));
-                            add_move(list, encode_move(source_square, target_square, piece, r, 0, 0, 0, 0));
-                            add_move(list, encode_move(source_square, target_square, piece, b, 0, 0, 0, 0));
-                            add_move(list, encode_move(source_square, target_square, piece, n, 0, 0, 0, 0));
-                        } 
-                        else if(quiet){
-                            add_move(list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                            if ((source_square >= a7 && source_square <= h7) && !get_bit(occupancies[both], target_square + 8))
-                                add_move(list, encode_move(source_square, target_square + 8, piece, 0, 0, 1, 0, 0));
-                        }
-                    }
-
-                    // captures
-                    attacks = pawn_attacks[side][source_square] & occupancies[white];
-                    while (attacks) {
-                        target_square = __builtin_ctzll(attacks);
-                        if (source_square >= a2 && source_square <= h2) {
-                            add_move(list, encode_move(source_square, target_square, piece, q, 1, 0, 0, 0));
-                            add_move(list, encode_move(source_square, target_square, piece, r, 1, 0, 0, 0));
-                            add_move(list, encode_move(source_square, target_square, piece, b, 1, 0, 0, 0));
-                            add_move(list, encode_move(source_square, target_square, piece, n, 1, 0, 0, 0));
-                        } else {
-                            add_move(list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                        }
-                        pop_bit(attacks, target_square);
-                    }
-
-                    // en-passant
-                    if (enpassant != no_sq) {
-                        U64 ep = pawn_attacks[side][source_square] & (1ULL << enpassant);
-                        if (ep) {
-                            int t = __builtin_ctzll(ep);
-                            add_move(list, encode_move(source_square, t, piece, 0, 1, 0, 1, 0));
-                        }
-                    }
-
-                    pop_bit(bitboard, source_square);
-                }
-            }
+// shift a bitboard one rank towards the promotion rank of Us
+template<int Us>
+constexpr U64 shift_up(U64 bb) { return Us == white ? bb >> 8 : bb << 8; }
 
-            // Black castling
-            if (piece == k) {
-                if (castle & bk) {
-                    if (!get_bit(occupancies[both], f8) && !get_bit(occupancies[both], g8)) {
-                        if (!is_square_attacked(board,  e8, white) && !is_square_attacked(board,  f8, white))
-                            add_move(list, encode_move(e8, g8, piece, 0, 0, 0, 0, 1));
-                    }
-                }
-                if (castle & bq) {
-                    if (!get_bit(occupancies[both], d8) && !get_bit(occupancies[both], c8) && !get_bit(occupancies[both], b8)) {
-                        if (!is_square_attacked(board,  e8, white) && !is_square_attacked(board,  d8, white))
-                            add_move(list, encode_move(e8, c8, piece, 0, 0, 0, 0, 1));
-                    }
-                }
-            }
+// pawn captures towards the a-file / h-file
+template<int Us>
+constexpr U64 shift_up_west(U64 bb) { return Us == white ? (bb >> 9) & not_h_file : (bb << 7) & not_h_file; }
+
+template<int Us>
+constexpr U64 shift_up_east(U64 bb) { return Us == white ? (bb >> 7) & not_a_file : (bb << 9) & not_a_file; }
+
+constexpr U64 rank_8_bb = 0x00000000000000FFULL;
+constexpr U64 rank_7_bb = rank_8_bb << 8;
+constexpr U64 rank_6_bb = rank_8_bb << 16;
+constexpr U64 rank_3_bb = rank_8_bb << 40;
+constexpr U64 rank_2_bb = rank_8_bb << 48;
+
+// everything a generator needs about the position, computed once per call
+struct GenState {
+    U64 occ, own, enemy;
+    U64 checkers;
+    U64 pinned;         // own pieces pinned to our king
+    U64 discovered;     // own pieces whose move may uncover a check (gen_quiet_checks)
+    int ksq, their_ksq;
+};
+
+// a pinned piece must stay on the line through its king
+inline bool pin_ok(const GenState& gs, int source_square, int target_square) {
+    return !get_bit(gs.pinned, source_square) || get_bit(line_bb[gs.ksq][source_square], target_square);
+}
+
+// a quiet move checks directly, or uncovers a check by leaving the line to their king
+inline bool checks_ok(const GenState& gs, U64 check_squares, int source_square, int target_square) {
+    return get_bit(check_squares, target_square)
+        || (get_bit(gs.discovered, source_square) && !get_bit(line_bb[gs.their_ksq][source_square], target_square));
+}
+
+template<int Type>
+inline void add_promotions(MoveList& list, int source_square, int target_square) {
+    // queen promotions belong to the captures, underpromotions to the quiets
+    if constexpr (Type != gen_quiets)
+        add_move(list, encode_move(source_square, target_square, move_promotion, Q));
+    if constexpr (Type != gen_captures) {
+        add_move(list, encode_move(source_square, target_square, move_promotion, R));
+        add_move(list, encode_move(source_square, target_square, move_promotion, B));
+        add_move(list, encode_move(source_square, target_square, move_promotion, N));
+    }
+}
+
+// Pawns are generated set-wise: all pushes and captures in one direction at once,
+// with the source square recovered from the shift
+template<int Us, int Type>
+void generate_pawn_moves(MoveList& list, const Board& board, const GenState& gs, U64 target) {
+    constexpr int Them  = Us ^ 1;
+    constexpr int pawn  = Us == white ? P : p;
+    constexpr int up    = Us == white ? -8 : 8;
+    constexpr int west  = Us == white ? -9 : 7;
+    constexpr int east  = Us == white ? -7 : 9;
+    constexpr U64 rank7 = Us == white ? rank_7_bb : rank_2_bb;
+    constexpr U64 rank3 = Us == white ? rank_3_bb : rank_6_bb;
+
+    const U64 pawns   = board.bitboards[pawn];
+    const U64 on7     = pawns & rank7;
+    const U64 not7    = pawns & ~rank7;
+    const U64 empty   = ~gs.occ;
+    const U64 enemies = Type == gen_evasions ? gs.checkers : gs.enemy;
+
+    // single and double pushes
+    if constexpr (Type != gen_captures) {
+        U64 single  = shift_up<Us>(not7) & empty;
+        U64 double_ = shift_up<Us>(single & rank3) & empty;
+
+        if constexpr (Type == gen_evasions) { single &= target; double_ &= target; }
+
+        const U64 check_squares = board.check_info.check_squares[P];
+        while (single) {
+            int to = __builtin_ctzll(single);
+            pop_bit(single, to);
+            if (!pin_ok(gs, to - up, to)) continue;
+            if (Type == gen_quiet_checks && !checks_ok(gs, check_squares, to - up, to)) continue;
+            add_move(list, encode_move(to - up, to));
         }
+        while (double_) {
+            int to = __builtin_ctzll(double_);
+            pop_bit(double_, to);
+            if (!pin_ok(gs, to - 2 * up, to)) continue;
+            if (Type == gen_quiet_checks && !checks_ok(gs, check_squares, to - 2 * up, to)) continue;
+            add_move(list, encode_move(to - 2 * up, to));
+        }
+    }
 
-        // Knights
-        if ((side == white) ? piece == N : piece == n) {
-            while (bitboard) {
-                source_square = __builtin_ctzll(bitboard);
-                attacks = knight_attacks[source_square] & ((side == white) ? ~occupancies[white] : ~occupancies[black]);
-                while (attacks) {
-                    target_square = __builtin_ctzll(attacks);
-                    bool isCap = get_bit((side == white ? occupancies[black] : occupancies[white]), target_square);
-                    if (isCap) {
-                        add_move(list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                    }
-                    else if(quiet){ 
-                        add_move(list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    }
-                    pop_bit(attacks, target_square);
-                }
-                pop_bit(bitboard, source_square);
+    // promotions, by push and by capture
+    if constexpr (Type != gen_quiet_checks) {
+        if (on7) {
+            U64 push = shift_up<Us>(on7) & empty;
+            if constexpr (Type == gen_evasions) push &= target;
+            U64 cap_w = shift_up_west<Us>(on7) & enemies;
+            U64 cap_e = shift_up_east<Us>(on7) & enemies;
+
+            while (push) {
+                int to = __builtin_ctzll(push);
+                pop_bit(push, to);
+                if (pin_ok(gs, to - up, to)) add_promotions<Type>(list, to - up, to);
+            }
+            while (cap_w) {
+                int to = __builtin_ctzll(cap_w);
+                pop_bit(cap_w, to);
+                if (pin_ok(gs, to - west, to)) add_promotions<Type>(list, to - west, to);
+            }
+            while (cap_e) {
+                int to = __builtin_ctzll(cap_e);
+                pop_bit(cap_e, to);
+                if (pin_ok(gs, to - east, to)) add_promotions<Type>(list, to - east, to);
             }
         }
+    }
 
-        // Bishops
-        if ((side == white) ? piece == B : piece == b) {
-            while (bitboard) {
-                source_square = __builtin_ctzll(bitboard);
-                attacks = get_bishop_attacks(source_square, occupancies[both]) & ((side == white) ? ~occupancies[white] : ~occupancies[black]);
-                while (attacks) {
-                    target_square = __builtin_ctzll(attacks);
-                    bool isCap = get_bit((side == white ? occupancies[black] : occupancies[white]), target_square);
-                    if (isCap) {
-                        add_move(list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                    }
-                    else if(quiet){ 
-                        add_move(list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    }
-                    pop_bit(attacks, target_square);
-                }
-                pop_bit(bitboard, source_square);
-            }
+    // plain captures and en-passant
+    if constexpr (Type == gen_captures || Type == gen_evasions || Type == gen_non_evasions) {
+        U64 cap_w = shift_up_west<Us>(not7) & enemies;
+        U64 cap_e = shift_up_east<Us>(not7) & enemies;
+
+        while (cap_w) {
+            int to = __builtin_ctzll(cap_w);
+            pop_bit(cap_w, to);
+            if (pin_ok(gs, to - west, to)) add_move(list, encode_move(to - west, to));
+        }
+        while (cap_e) {
+            int to = __builtin_ctzll(cap_e);
+            pop_bit(cap_e, to);
+            if (pin_ok(gs, to - east, to)) add_move(list, encode_move(to - east, to));
         }
 
-        // Rooks
-        if ((side == white) ? piece == R : piece == r) {
-            while (bitboard) {
-                source_square = __builtin_ctzll(bitboard);
-                attacks = get_rook_attacks(source_square, occupancies[both]) & ((side == white) ? ~occupancies[white] : ~occupancies[black]);
-                while (attacks) {
-                    target_square = __builtin_ctzll(attacks);
-                    bool isCap = get_bit((side == white ? occupancies[black] : occupancies[white]), target_square);
-                    if (isCap) {
-                        add_move(list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                    }
-                    else if(quiet){ 
-                        add_move(list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    }
-                    pop_bit(attacks, target_square);
-                }
-                pop_bit(bitboard, source_square);
+        // en-passant: replay the occupancy change, which covers pins, the captured
+        // pawn being the checker and the horizontal discovered check
+        const int ep = board.enpassant;
+        if (ep != no_sq) {
+            U64 from = not7 & pawn_attacks[Them][ep];
+            const int cap_sq = ep - up;
+            while (from) {
+                int source_square = __builtin_ctzll(from);
+                pop_bit(from, source_square);
+                U64 occ_after = (gs.occ ^ (1ULL << source_square) ^ (1ULL << cap_sq)) | (1ULL << ep);
+                if (!is_square_attacked_occ(board, gs.ksq, Them, occ_after, cap_sq))
+                    add_move(list, encode_move(source_square, ep, move_enpassant));
             }
         }
+    }
+}
 
-        // Queens
-        if ((side == white) ? piece == Q : piece == q) {
-            while (bitboard) {
-                source_square = __builtin_ctzll(bitboard);
-                attacks = get_queen_attacks(source_square, occupancies[both]) & ((side == white) ? ~occupancies[white] : ~occupancies[black]);
-                while (attacks) {
-                    target_square = __builtin_ctzll(attacks);
-                    bool isCap = get_bit((side == white ? occupancies[black] : occupancies[white]), target_square);
-                    if (isCap) {
-                        add_move(list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                    }
-                    else if(quiet){ 
-                        add_move(list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    }
-                    pop_bit(attacks, target_square);
-                }
-                pop_bit(bitboard, source_square);
-            }
+// Knights, bishops, rooks and queens; Pt is the white piece code
+template<int Us, int Type, int Pt>
+void generate_piece_moves(MoveList& list, const Board& board, const GenState& gs, U64 target) {
+    constexpr int piece = Us == white ? Pt : Pt + 6;
+
+    const U64 check_squares = board.check_info.check_squares[Pt];
+
+    // a pinned knight can never move
+    U64 bitboard = board.bitboards[piece];
+    if constexpr (Pt == N) bitboard &= ~gs.pinned;
+
+    while (bitboard) {
+        int source_square = __builtin_ctzll(bitboard);
+        pop_bit(bitboard, source_square);
+
+        U64 attacks;
+        if constexpr (Pt == N)      attacks = knight_attacks[source_square];
+        else if constexpr (Pt == B) attacks = get_bishop_attacks(source_square, gs.occ);
+        else if constexpr (Pt == R) attacks = get_rook_attacks(source_square, gs.occ);
+        else                        attacks = get_queen_attacks(source_square, gs.occ);
+
+        attacks &= target;
+        if (get_bit(gs.pinned, source_square)) attacks &= line_bb[gs.ksq][source_square];
+
+        if constexpr (Type == gen_quiet_checks) {
+            U64 uncover = get_bit(gs.discovered, source_square) ? ~line_bb[gs.their_ksq][source_square] : 0ULL;
+            attacks &= check_squares | uncover;
         }
 
-        // Kings (normal king steps)
-        if ((side == white) ? piece == K : piece == k) {
-            while (bitboard) {
-                source_square = __builtin_ctzll(bitboard);
-                attacks = king_attacks[source_square] & ((side == white) ? ~occupancies[white] : ~occupancies[black]);
-                while (attacks) {
-                    target_square = __builtin_ctzll(attacks);
-                    bool isCap = get_bit((side == white ? occupancies[black] : occupancies[white]), target_square);
-                    if (isCap) {
-                        add_move(list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                    }
-                    else if(quiet){ 
-                        add_move(list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    }
-                    pop_bit(attacks, target_square);
-                }
-                pop_bit(bitboard, source_square);
-            }
+        while (attacks) {
+            int target_square = __builtin_ctzll(attacks);
+            pop_bit(attacks, target_square);
+            add_move(list, encode_move(source_square, target_square));
         }
     }
 }
 
+template<int Us, int Type>
+void generate_all(MoveList& list, const Board& board) {
+    constexpr int Them = Us ^ 1;
+
+    GenState gs;
+    gs.occ       = board.occupancies[both];
+    gs.own       = board.occupancies[Us];
+    gs.enemy     = board.occupancies[Them];
+    gs.checkers  = board.check_info.checkers;
+    gs.ksq       = board.king_sq[Us];
+    gs.their_ksq = board.king_sq[Them];
+    gs.pinned    = board.check_info.blockers[Us] & gs.own;
+    gs.discovered = board.check_info.blockers[Them] & gs.own;
+
+    const U64 checkers = gs.checkers;
+
+    // double check: only the king can move
+    if (Type != gen_evasions || !(checkers & (checkers - 1))) {
+        // squares a non-king move may land on
+        U64 target;
+        if constexpr (Type == gen_captures)          target = gs.enemy;
+        else if constexpr (Type == gen_evasions)     target = between_bb[gs.ksq][__builtin_ctzll(checkers)] | checkers;
+        else if constexpr (Type == gen_non_evasions) target = ~gs.own;
+        else                                         target = ~gs.occ;
+
+        generate_pawn_moves<Us, Type>(list, board, gs, target);
+        generate_piece_moves<Us, Type, N>(list, board, gs, target);
+        generate_piece_moves<Us, Type, B>(list, board, gs, target);
+        generate_piece_moves<Us, Type, R>(list, board, gs, target);
+        generate_piece_moves<Us, Type, Q>(list, board, gs, target);
+    }
+
+    // king moves cannot check directly; discovered checks by the king are left out
+    if constexpr (Type == gen_quiet_checks) return;
+
+    // Castling: never out of check, and neither square the king crosses may be attacked
+    if constexpr (Type == gen_quiets || Type == gen_non_evasions) {
+        constexpr int ks = Us == white ? wk : bk;
+        constexpr int qs = Us == white ? wq : bq;
+        constexpr int e  = Us == white ? e1 : e8;
+        constexpr int f  = Us == white ? f1 : f8;
+        constexpr int g  = Us == white ? g1 : g8;
+        constexpr int d  = Us == white ? d1 : d8;
+        constexpr int c  = Us == white ? c1 : c8;
+        constexpr int b_ = Us == white ? b1 : b8;
+        const U64 occ = gs.occ;
+
+        if ((board.castle & ks) && !get_bit(occ, f) && !get_bit(occ, g)
+            && !is_square_attacked(board, f, Them) && !is_square_attacked(board, g, Them))
+            add_move(list, encode_move(e, g, move_castling));
+        if ((board.castle & qs) && !get_bit(occ, d) && !get_bit(occ, c) && !get_bit(occ, b_)
+            && !is_square_attacked(board, d, Them) && !is_square_attacked(board, c, Them))
+            add_move(list, encode_move(e, c, move_castling));
+    }
+
+    // King steps: test the target with the king lifted off, so sliders see through it
+    U64 king_target;
+    if constexpr (Type == gen_captures)    king_target = gs.enemy;
+    else if constexpr (Type == gen_quiets) king_target = ~gs.occ;
+    else                                   king_target = ~gs.own;
+
+    const U64 occ_no_king = gs.occ ^ (1ULL << gs.ksq);
+    U64 attacks = king_attacks[gs.ksq] & king_target;
+    while (attacks) {
+        int target_square = __builtin_ctzll(attacks);
+        pop_bit(attacks, target_square);
+        bool isCap = get_bit(gs.enemy, target_square);
+        if (!is_square_attacked_occ(board, target_square, Them, occ_no_king, isCap ? target_square : no_sq))
+            add_move(list, encode_move(gs.ksq, target_square));
+    }
+}
+
+} // namespace
+
+template<int Type>
+void generate(MoveList& list, const Board& board) {
+    if (board.side == white) generate_all<white, Type>(list, board);
+    else                     generate_all<black, Type>(list, board);
+}
+
+template void generate<gen_captures>(MoveList&, const Board&);
+template void generate<gen_quiets>(MoveList&, const Board&);
+template void generate<gen_quiet_checks>(MoveList&, const Board&);
+template void generate<gen_evasions>(MoveList&, const Board&);
+template void generate<gen_non_evasions>(MoveList&, const Board&);
+
+void generate_captures(MoveList& list, const Board& board)     { generate<gen_captures>(list, board); }
+void generate_quiets(MoveList& list, const Board& board)       { generate<gen_quiets>(list, board); }
+void generate_evasions(MoveList& list, const Board& board)     { generate<gen_evasions>(list, board); }
+void generate_quiet_checks(MoveList& list, const Board& board) { generate<gen_quiet_checks>(list, board); }
+
+void generate_moves(MoveList& list, const Board& board) {
+    list.count = 0;
+    const bool evasions = board.check_info.checkers;
+    if (board.side == white) {
+        if (evasions) generate_all<white, gen_evasions>(list, board);
+        else          generate_all<white, gen_non_evasions>(list, board);
+    } else {
+        if (evasions) generate_all<black, gen_evasions>(list, board);
+        else          generate_all<black, gen_non_evasions>(list, board);
+    }
+}
+
 } // namespace bbc
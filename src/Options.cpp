@@ -0,0 +1,137 @@
+# include "Options.hpp"
+# include <cctype>
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+
+namespace bbc{
+
+namespace {
+
+bool iequals(const std::string& a, const std::string& b){
+    if(a.size() != b.size()) return false;
+    for(size_t i = 0; i < a.size(); i++)
+        if(std::tolower((unsigned char)a[i]) != std::tolower((unsigned char)b[i])) return false;
+    return true;
+}
+
+std::string trim(const std::string& s){
+    size_t first = s.find_first_not_of(" \t\r\n");
+    if(first == std::string::npos) return "";
+    size_t last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+} // namespace
+
+void OptionsMap::add_check(const std::string& name, bool default_value, OptionHandler on_change){
+    Option o;
+    o.name = name;
+    o.type = option_check;
+    o.default_value = o.value = default_value ? "true" : "false";
+    o.on_change = std::move(on_change);
+    options.push_back(std::move(o));
+}
+
+void OptionsMap::add_spin(const std::string& name, int default_value, int min, int max,
+                          OptionHandler on_change){
+    Option o;
+    o.name = name;
+    o.type = option_spin;
+    o.default_value = o.value = std::to_string(default_value);
+    o.min = min;
+    o.max = max;
+    o.on_change = std::move(on_change);
+    options.push_back(std::move(o));
+}
+
+void OptionsMap::add_string(const std::string& name, const std::string& default_value,
+                            OptionHandler on_change){
+    Option o;
+    o.name = name;
+    o.type = option_string;
+    o.default_value = o.value = default_value;
+    o.on_change = std::move(on_change);
+    options.push_back(std::move(o));
+}
+
+void OptionsMap::print_uci() const {
+    for(const Option& o : options){
+        switch(o.type){
+            case option_check:
+                std::printf("option name %s type check default %s\n", o.name.c_str(), o.default_value.c_str());
+                break;
+            case option_spin:
+                std::printf("option name %s type spin default %s min %d max %d\n",
+                            o.name.c_str(), o.default_value.c_str(), o.min, o.max);
+                break;
+            case option_string:
+                std::printf("option name %s type string default %s\n", o.name.c_str(),
+                            o.default_value.empty() ? "<empty>" : o.default_value.c_str());
+                break;
+        }
+    }
+}
+
+const Option* OptionsMap::find(const std::string& name) const {
+    for(const Option& o : options)
+        if(iequals(o.name, name)) return &o;
+    return nullptr;
+}
+
+Option* OptionsMap::find_mutable(const std::string& name){
+    return const_cast<Option*>(static_cast<const OptionsMap*>(this)->find(name));
+}
+
+bool OptionsMap::setoption(const char* command){
+    // names and values may contain spaces: split on the " value " token
+    const char* name_at = std::strstr(command, "name ");
+    if(!name_at){
+        std::printf("info string setoption without a name\n");
+        return false;
+    }
+    name_at += 5;
+    const char* value_at = std::strstr(name_at, " value ");
+
+    std::string name  = trim(value_at ? std::string(name_at, value_at) : std::string(name_at));
+    std::string value = trim(value_at ? std::string(value_at + 7) : std::string());
+
+    Option* o = find_mutable(name);
+    if(!o){
+        std::printf("info string unknown option %s\n", name.c_str());
+        return false;
+    }
+
+    switch(o->type){
+        case option_check:
+            if(value != "true" && value != "false"){
+                std::printf("info string option %s expects true or false, got '%s'\n", o->name.c_str(), value.c_str());
+                return false;
+            }
+            break;
+        case option_spin: {
+            char* end = nullptr;
+            long v = value.empty() ? 0 : std::strtol(value.c_str(), &end, 10);
+            if(value.empty() || *end || v < o->min || v > o->max){
+                std::printf("info string option %s expects an integer in [%d, %d], got '%s'\n",
+                            o->name.c_str(), o->min, o->max, value.c_str());
+                return false;
+            }
+            value = std::to_string(v);
+            break;
+        }
+        case option_string:
+            if(value == "<empty>") value.clear();
+            break;
+    }
+
+    std::string previous = std::move(o->value);
+    o->value = value;
+    if(o->on_change && !o->on_change(*o)){
+        o->value = std::move(previous);
+        return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,212 @@
+# include "Perft.hpp"
+# include "Threads.hpp"
+# include "UCI.hpp"
+# include <cstring>
+# include <memory>
+# include <vector>
+
+namespace bbc{
+
+namespace {
+
+// (hash, depth) -> node count; entries are written without locks, so the key is stored
+// xor'ed with the data and a torn write simply fails the probe
+class PerftTable {
+public:
+    explicit PerftTable(size_t mb) : table() {
+        size_t entries = mb * 1024 * 1024 / sizeof(Entry);
+        entries = entries ? (size_t(1) << std::__lg(entries)) : 0;
+        table = std::vector<Entry>(entries);
+        mask = entries - 1;
+    }
+
+    bool probe(U64 key, int depth, U64& nodes) const {
+        const Entry& e = table[key & mask];
+        const U64 data = e.data.load(std::memory_order_relaxed);
+        if ((e.check.load(std::memory_order_relaxed) ^ data) != key || int(data & 63) != depth) return false;
+        nodes = data >> 6;
+        return true;
+    }
+
+    void store(U64 key, int depth, U64 nodes) {
+        Entry& e = table[key & mask];
+        const U64 data = (nodes << 6) | U64(depth);
+        e.check.store(key ^ data, std::memory_order_relaxed);
+        e.data.store(data, std::memory_order_relaxed);
+    }
+
+    bool enabled() const { return !table.empty(); }
+
+private:
+    struct Entry {
+        std::atomic<U64> check{0};
+        std::atomic<U64> data{0};
+    };
+    std::vector<Entry> table;
+    size_t mask = 0;
+};
+
+// legal move generation: depth 1 is the move count, no make/undo at the leaves
+U64 bulk_count(Board& board, int depth, PerftTable* tt)
+{
+    MoveList move_list;
+    generate_moves(move_list, board);
+    if (depth <= 1) return depth == 1 ? U64(move_list.count) : 1;
+
+    U64 nodes = 0;
+    if (tt && tt->probe(board.hash, depth, nodes)) return nodes;
+
+    StateInfo st;
+    for (int i = 0; i < move_list.count; i++) {
+        make_move(move_list.moves[i], all_moves, board, st);
+        nodes += bulk_count(board, depth - 1, tt);
+        undo_move(board, st, move_list.moves[i]);
+    }
+
+    if (tt) tt->store(board.hash, depth, nodes);
+    return nodes;
+}
+
+} // namespace
+
+PerftResult perft_parallel(const Board& board, int depth, int threads, size_t hash_mb)
+{
+    PerftResult result;
+    if (depth <= 0) { result.nodes = 1; return result; }
+
+    generate_moves(result.root_moves, board);
+
+    PerftTable table(hash_mb);
+    PerftTable* tt = table.enabled() ? &table : nullptr;
+
+    ThreadPool pool(std::min(threads, std::max(result.root_moves.count, 1)));
+
+    // one board per worker (the board is large, so it lives on the heap)
+    std::vector<std::unique_ptr<Board>> boards;
+    for (int i = 0; i < pool.size(); i++) boards.push_back(std::make_unique<Board>(board));
+
+    pool.run(result.root_moves.count, [&](int index, int worker) {
+        Board& b = *boards[worker];
+        StateInfo st;
+        const Move move = result.root_moves.moves[index];
+
+        make_move(move, all_moves, b, st);
+        result.move_nodes[index] = bulk_count(b, depth - 1, tt);
+        undo_move(b, st, move);
+    });
+
+    for (int i = 0; i < result.root_moves.count; i++) result.nodes += result.move_nodes[i];
+    return result;
+}
+
+// perft test
+U64 perft_test(const Board& board, int depth, int threads, size_t hash_mb)
+{
+    printf("\n     Performance test\n\n");
+
+    // init start time
+    U64 start = get_time_ms();
+
+    PerftResult result = perft_parallel(board, depth, threads, hash_mb);
+    U64 ms = get_time_ms() - start;
+
+    // print move
+    for (int i = 0; i < result.root_moves.count; i++)
+        printf("     move: %-5s  nodes: %llu\n", move_string(result.root_moves.moves[i]).c_str(),
+                                                (unsigned long long)result.move_nodes[i]);
+
+    // print results
+    printf("\n    Depth: %d\n", depth);
+    printf("    Nodes: %llu\n", (unsigned long long)result.nodes);
+    printf("     Time: %llu\n", (unsigned long long)ms);
+    printf("      NPS: %llu\n\n", (unsigned long long)(result.nodes * 1000 / (ms ? ms : 1)));
+
+    return result.nodes;
+}
+
+int parse_perft_driver(const char* name)
+{
+    const char* names[] = { "bulk", "hash", "make", "legal" };
+    for (int driver = perft_bulk; driver <= perft_legal; driver++)
+        if (std::strncmp(name, names[driver], std::strlen(names[driver])) == 0) return driver;
+    return -1;
+}
+
+U64 perft_run(const Board& board, int depth, int driver, int threads)
+{
+    switch (driver) {
+        case perft_hash: return perft_parallel(board, depth, threads, 64).nodes;
+        case perft_make:
+        case perft_legal: {
+            auto copy = std::make_unique<Board>(board);
+            return driver == perft_make ? perft_driver(*copy, depth) : perft_driver_legal(*copy, depth);
+        }
+        default: return perft_parallel(board, depth, threads).nodes;
+    }
+}
+
+namespace {
+
+struct PerftCase {
+    const char* fen;
+    int depth;
+    U64 nodes;
+};
+
+// the debug positions from UCI.hpp (tricky_position is kiwipete), then the standard
+// chessprogramming positions 3-6 and a set of en-passant, castling and promotion traps
+const PerftCase perft_cases[] = {
+    { start_position,  6, 119060324 },
+    { tricky_position, 5, 193690690 },
+    { killer_position, 5, 36112837 },
+    { cmk_position,    5, 69838845 },
+    { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083 },
+    { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292 },
+    { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5, 89941194 },
+    { "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 5, 164075551 },
+    { "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888 },
+    { "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133 },
+    { "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467 },
+    { "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072 },
+    { "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711 },
+    { "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206 },
+    { "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476 },
+    { "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001 },
+    { "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658 },
+    { "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342 },
+    { "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683 },
+    { "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217 },
+    { "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584 },
+    { "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527 },
+};
+
+} // namespace
+
+bool perft_suite(int driver, int threads)
+{
+    auto board = std::make_unique<Board>();
+    int failed = 0;
+    U64 total_nodes = 0;
+    U64 suite_start = get_time_ms();
+
+    for (const PerftCase& c : perft_cases) {
+        board->parse_fen(c.fen);
+
+        U64 start = get_time_ms();
+        U64 nodes = perft_run(*board, c.depth, driver, threads);
+        U64 ms = get_time_ms() - start;
+
+        total_nodes += nodes;
+        if (nodes != c.nodes) failed++;
+        printf("info string perftsuite %-4s depth %d nodes %llu expected %llu time %llu nps %llu fen %s\n",
+               nodes == c.nodes ? "ok" : "FAIL", c.depth, (unsigned long long)nodes, (unsigned long long)c.nodes,
+               (unsigned long long)ms, (unsigned long long)(nodes * 1000 / (ms ? ms : 1)), c.fen);
+    }
+
+    U64 ms = get_time_ms() - suite_start;
+    printf("info string perftsuite %s failed %d nodes %llu time %llu nps %llu\n", failed ? "FAILED" : "ok", failed,
+           (unsigned long long)total_nodes, (unsigned long long)ms, (unsigned long long)(total_nodes * 1000 / (ms ? ms : 1)));
+    return failed == 0;
+}
+
+}
\ No newline at end of file
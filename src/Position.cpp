@@ -1,4 +1,5 @@
 #include "Position.hpp"
+#include <cassert>
 
 namespace bbc{
 
@@ -28,8 +29,8 @@ int is_square_attacked(const Board& board, int square, int side_) {
 
 // Attack test with custom occupancy and an optional "removed" square
 // (used for captures / en-passant so captured enemy pieces don't still count).
-static inline int is_square_attacked_occ(const Board& board, int square, int attacker_side,
-                                         U64 occupied, int removed_sq) {
+int is_square_attacked_occ(const Board& board, int square, int attacker_side,
+                           U64 occupied, int removed_sq) {
     U64 pawns, knights, bishops, rooks, queens, king;
 
     if (attacker_side == white) {
@@ -78,6 +79,235 @@ static inline int is_square_attacked_occ(const Board& board, int square, int att
     return 0;
 }
 
+// All attackers of both colors; sliders see through squares cleared from occupied
+U64 attackers_to(const Board& board, int square, U64 occupied) {
+    const auto& bitboards = board.bitboards;
+
+    return (pawn_attacks[black][square] & bitboards[P])
+         | (pawn_attacks[white][square] & bitboards[p])
+         | (knight_attacks[square] & (bitboards[N] | bitboards[n]))
+         | (get_bishop_attacks(square, occupied) & (bitboards[B] | bitboards[b] | bitboards[Q] | bitboards[q]))
+         | (get_rook_attacks(square, occupied)   & (bitboards[R] | bitboards[r] | bitboards[Q] | bitboards[q]))
+         | (king_attacks[square] & (bitboards[K] | bitboards[k]));
+}
+
+// Pieces that are the only blocker between ksq and a slider of attacker_side
+U64 slider_blockers(const Board& board, int ksq, int attacker_side, U64& pinners) {
+    const auto& bitboards = board.bitboards;
+    const U64 occ = board.occupancies[both];
+
+    const U64 diagonal   = (attacker_side == white) ? (bitboards[B] | bitboards[Q]) : (bitboards[b] | bitboards[q]);
+    const U64 orthogonal = (attacker_side == white) ? (bitboards[R] | bitboards[Q]) : (bitboards[r] | bitboards[q]);
+
+    // sliders lined up with the king on an empty board
+    U64 snipers  = (get_bishop_attacks(ksq, 0ULL) & diagonal) | (get_rook_attacks(ksq, 0ULL) & orthogonal);
+    U64 blockers = 0ULL;
+    pinners = 0ULL;
+
+    while (snipers) {
+        int sq = __builtin_ctzll(snipers);
+        U64 between = between_bb[ksq][sq] & occ;
+
+        // exactly one piece in between
+        if (between && !(between & (between - 1))) {
+            blockers |= between;
+            if (between & board.occupancies[attacker_side ^ 1]) pinners |= 1ULL << sq;
+        }
+        pop_bit(snipers, sq);
+    }
+    return blockers;
+}
+
+// Checkers, blockers and check squares of the current position, computed once per move
+void set_check_info(Board& board) {
+    CheckInfo& ci = board.check_info;
+    const int us        = board.side;
+    const int them      = us ^ 1;
+    const int their_ksq = board.king_sq[them];
+    const U64 occ       = board.occupancies[both];
+
+    ci.checkers = attackers_to(board, board.king_sq[us], occ) & board.occupancies[them];
+
+    ci.blockers[white] = slider_blockers(board, board.king_sq[white], black, ci.pinners[black]);
+    ci.blockers[black] = slider_blockers(board, board.king_sq[black], white, ci.pinners[white]);
+
+    ci.check_squares[P] = pawn_attacks[them][their_ksq];
+    ci.check_squares[N] = knight_attacks[their_ksq];
+    ci.check_squares[B] = get_bishop_attacks(their_ksq, occ);
+    ci.check_squares[R] = get_rook_attacks(their_ksq, occ);
+    ci.check_squares[Q] = ci.check_squares[B] | ci.check_squares[R];
+    ci.check_squares[K] = 0ULL;
+}
+
+// Answered from check_info before the move is made: direct checks hit a check square,
+// discovered checks move a blocker off its line, the rest replay the occupancy
+bool gives_check(const Board& board, int move) {
+    const CheckInfo& ci = board.check_info;
+    const int us        = board.side;
+    const int them      = us ^ 1;
+    const int their_ksq = board.king_sq[them];
+
+    const int source_square = get_move_source(move);
+    const int target_square = get_move_target(move);
+    const int piece         = get_move_piece(board, move);
+    const int promoted      = get_move_promoted_type(move);
+
+    // direct check by the moved piece (promotion squares are never pawn check squares)
+    if (get_bit(ci.check_squares[piece % 6], target_square)) return true;
+
+    // discovered check: a blocker of their king leaves the line
+    if (get_bit(ci.blockers[them], source_square)
+        && (!get_bit(line_bb[their_ksq][source_square], target_square) || get_move_castling(move)))
+        return true;
+
+    const U64 occ = (board.occupancies[both] ^ (1ULL << source_square)) | (1ULL << target_square);
+
+    if (promoted) {
+        switch (promoted) {
+            case N:  return get_bit(knight_attacks[target_square], their_ksq);
+            case B:  return get_bit(get_bishop_attacks(target_square, occ), their_ksq);
+            case R:  return get_bit(get_rook_attacks(target_square, occ), their_ksq);
+            default: return get_bit(get_queen_attacks(target_square, occ), their_ksq);
+        }
+    }
+
+    // en-passant: the captured pawn may uncover a slider
+    if (get_move_enpassant(move)) {
+        const int cap_sq = (us == white) ? target_square + 8 : target_square - 8;
+        const U64 occ_ep = occ ^ (1ULL << cap_sq);
+        const auto& bb = board.bitboards;
+        const U64 diagonal   = (us == white) ? (bb[B] | bb[Q]) : (bb[b] | bb[q]);
+        const U64 orthogonal = (us == white) ? (bb[R] | bb[Q]) : (bb[r] | bb[q]);
+        return (get_bishop_attacks(their_ksq, occ_ep) & diagonal) | (get_rook_attacks(their_ksq, occ_ep) & orthogonal);
+    }
+
+    // castling: the rook lands on f1/d1 (f8/d8)
+    if (get_move_castling(move)) {
+        int rook_to;
+        switch (target_square) {
+            case g1: rook_to = f1; break;
+            case c1: rook_to = d1; break;
+            case g8: rook_to = f8; break;
+            default: rook_to = d8; break;
+        }
+        return get_bit(ci.check_squares[R], rook_to);
+    }
+
+    return false;
+}
+
+// -----------------------------
+// Static exchange evaluation
+// -----------------------------
+// Plays out the capture sequence on the target square, always recapturing with
+// the least valuable attacker, and reports whether the mover ends up with at
+// least `threshold` material. Pins are ignored.
+bool see_ge(const Board& board, int move, int threshold) {
+    // en-passant, castling and promotions are treated as an even trade
+    if (get_move_type(move) != move_normal)
+        return 0 >= threshold;
+
+    const auto& bitboards = board.bitboards;
+    const int source_square = get_move_source(move);
+    const int target_square = get_move_target(move);
+    const int victim        = board.piece_at[target_square];
+
+    // 1) Winning the victim outright must already reach the threshold
+    int swap = (victim == no_piece ? 0 : see_values[victim]) - threshold;
+    if (swap < 0) return false;
+
+    // 2) Even losing the mover for nothing keeps us above the threshold
+    swap = see_values[board.piece_at[source_square]] - swap;
+    if (swap <= 0) return true;
+
+    U64 occupied  = board.occupancies[both] ^ (1ULL << source_square) ^ (1ULL << target_square);
+    U64 attackers = attackers_to(board, target_square, occupied);
+
+    const U64 diagonal   = bitboards[B] | bitboards[b] | bitboards[Q] | bitboards[q];
+    const U64 orthogonal = bitboards[R] | bitboards[r] | bitboards[Q] | bitboards[q];
+
+    int stm = board.side;
+    int res = 1;
+
+    // 3) Alternate recaptures, re-adding x-ray attackers behind each capturer
+    while (true) {
+        stm ^= 1;
+        attackers &= occupied;
+
+        U64 stm_attackers = attackers & board.occupancies[stm];
+        if (!stm_attackers) break;
+
+        res ^= 1;
+
+        const int base = (stm == white) ? P : p;
+        U64 bb;
+
+        if ((bb = stm_attackers & bitboards[base + P])) {
+            if ((swap = see_values[P] - swap) < res) break;
+            occupied ^= 1ULL << get_ls1b_index(bb);
+            attackers |= get_bishop_attacks(target_square, occupied) & diagonal;
+        }
+        else if ((bb = stm_attackers & bitboards[base + N])) {
+            if ((swap = see_values[N] - swap) < res) break;
+            occupied ^= 1ULL << get_ls1b_index(bb);
+        }
+        else if ((bb = stm_attackers & bitboards[base + B])) {
+            if ((swap = see_values[B] - swap) < res) break;
+            occupied ^= 1ULL << get_ls1b_index(bb);
+            attackers |= get_bishop_attacks(target_square, occupied) & diagonal;
+        }
+        else if ((bb = stm_attackers & bitboards[base + R])) {
+            if ((swap = see_values[R] - swap) < res) break;
+            occupied ^= 1ULL << get_ls1b_index(bb);
+            attackers |= get_rook_attacks(target_square, occupied) & orthogonal;
+        }
+        else if ((bb = stm_attackers & bitboards[base + Q])) {
+            if ((swap = see_values[Q] - swap) < res) break;
+            occupied ^= 1ULL << get_ls1b_index(bb);
+            attackers |= (get_bishop_attacks(target_square, occupied) & diagonal)
+                       | (get_rook_attacks(target_square, occupied)   & orthogonal);
+        }
+        else {
+            // king recapture only stands if the other side has nothing left
+            return (attackers & ~board.occupancies[stm]) ? res ^ 1 : res;
+        }
+    }
+
+    return res;
+}
+
+U64 key_after(const Board& board, int move) {
+    const int from     = get_move_source(move);
+    const int to       = get_move_target(move);
+    const int piece    = board.piece_at[from];
+    const int captured = board.piece_at[to];
+    const int promoted = get_move_promoted(board, move);
+
+    U64 key = board.hash ^ random_side;
+    key ^= random_pieces[piece * 64 + from] ^ random_pieces[(promoted ? promoted : piece) * 64 + to];
+    if (captured != no_piece) key ^= random_pieces[captured * 64 + to];
+    if (get_move_enpassant(move)) {
+        const int cap_sq = to + (board.side == white ? 8 : -8);
+        key ^= random_pieces[board.piece_at[cap_sq] * 64 + cap_sq];
+    }
+
+    // the rook of a castling move (the target is the king's square)
+    if (get_move_castling(move)) {
+        const int rook     = (board.side == white) ? R : r;
+        const bool kingside = (to & 7) == 6;
+        const int rook_from = kingside ? to + 1 : to - 2;
+        const int rook_to   = kingside ? to - 1 : to + 1;
+        key ^= random_pieces[rook * 64 + rook_from] ^ random_pieces[rook * 64 + rook_to];
+    }
+
+    // castling rights, the old en-passant file and the one a double push sets (same file as to)
+    key ^= random_castling[board.castle] ^ random_castling[board.castle & castling_rights[from] & castling_rights[to]];
+    if (board.enpassant >= 16 && board.enpassant <= 23) key ^= random_file[board.enpassant - 16];
+    else if (board.enpassant >= 40 && board.enpassant <= 47) key ^= random_file[board.enpassant - 40];
+    if ((piece == P || piece == p) && std::abs(to - from) == 16) key ^= random_file[to & 7];
+    return key;
+}
+
 // Assumes move is pseudo-legal.
 // Returns 1 if legal, 0 if illegal.
 int check_legal(const Board& board, int move) {
@@ -86,8 +316,8 @@ int check_legal(const Board& board, int move) {
 
     const int source_square  = get_move_source(move);
     const int target_square  = get_move_target(move);
-    const int piece          = get_move_piece(move);
-    const bool capture       = get_move_capture(move);
+    const int piece          = get_move_piece(board, move);
+    const bool capture       = get_move_capture(board, move);
     const bool enpass        = get_move_enpassant(move);
     const bool castl         = get_move_castling(move);
 
@@ -158,6 +388,11 @@ int check_legal(const Board& board, int move) {
     // -----------------------------
     // 3) General move
     // -----------------------------
+    // Out of check only a pinned piece can expose the king, and not while it stays on the pin line
+    if (!board.check_info.checkers && piece != K && piece != k)
+        return !get_bit(board.check_info.blockers[us], source_square)
+            || get_bit(line_bb[king_sq][source_square], target_square);
+
     int removed_sq = no_sq;
     if (capture) removed_sq = target_square;
 
@@ -173,7 +408,7 @@ int check_legal(const Board& board, int move) {
 }
 
 // -----------------------------
-// Make move (with NO legality filter)
+// Make move (with NO legality filter, moves are generated legal)
 // -----------------------------
 int make_move(int move, int move_flag, Board& board, StateInfo& st) {
     auto& bitboards = board.bitboards;
@@ -185,20 +420,24 @@ int make_move(int move, int move_flag, Board& board, StateInfo& st) {
     auto& piece_at =board.piece_at;
 
     if (move_flag != all_moves) {
-        if (!get_move_capture(move)) return 0; // only accept captures
+        if (!get_move_capture(board, move)) return 0; // only accept captures
         // fallthrough to play it
     }
 
     // Preserve board state
     // Board copy; save_board(copy, board);
 
+#ifndef NDEBUG
+    const U64 expected_hash = key_after(board, move);
+#endif
+
     // Fields
     int source_square   = get_move_source(move);
     int target_square   = get_move_target(move);
-    int piece           = get_move_piece(move);
-    int promoted_piece  = get_move_promoted(move);
-    bool capture        = get_move_capture(move);
-    bool double_push    = get_move_double(move);
+    int piece           = get_move_piece(board, move);
+    int promoted_piece  = get_move_promoted(board, move);
+    bool capture        = get_move_capture(board, move);
+    bool double_push    = (piece == P || piece == p) && std::abs(target_square - source_square) == 16;
     bool enpass         = get_move_enpassant(move);
     bool castl          = get_move_castling(move);
 
@@ -210,6 +449,8 @@ int make_move(int move, int move_flag, Board& board, StateInfo& st) {
     st.old_king_sq[black] = board.king_sq[black];   
     // hash
     st.old_hash = board.hash;
+    st.old_pawn_hash = board.pawn_hash;
+    st.old_check_info = board.check_info;
     // pos history
     st.old_rep_len   = board.rep_len;
     st.old_rep_start = board.rep_start;
@@ -351,20 +592,17 @@ int make_move(int move, int move_flag, Board& board, StateInfo& st) {
     // 7) Side to move
     side ^= 1; ++ply;
     board.hash ^= random_side;
+    assert(board.hash == expected_hash); // key_after (TT prefetch) must track these updates
 
     // 8) Board history
     if(capture || piece==P || piece == p) board.rep_start = board.rep_len;
     board.rep_keys[board.rep_len++] = board.hash;
 
-    // 9-a) Legality: own king may not be in check
-    board.nnue_ply++;
-    int king_sq = board.king_sq[side^1];
-    if (is_square_attacked(board, king_sq, side)) {
-        undo_move(board, st, move);
-        return 0;
-    }
+    // 8a) Checkers, pins and check squares for the new side to move
+    set_check_info(board);
 
-    // 9-b) NNUE (update dirtyPiece if legal)
+    // 9) NNUE dirty pieces (legality is guaranteed by the generator)
+    board.nnue_ply++;
     auto& parent = board.nnue_stack[board.nnue_ply - 1];
     auto& child  = board.nnue_stack[board.nnue_ply];
     // child.accumulator = parent.accumulator; // copy accumulator from parent
@@ -445,8 +683,9 @@ void undo_move(Board& b, const StateInfo& st, const int move) {
 
         int source_square   = get_move_source(move);
         int target_square   = get_move_target(move);
-        int piece           = get_move_piece(move);
-        int promoted_piece  = get_move_promoted(move);
+        // the mover (or the promoted piece) now stands on the target square
+        int piece           = piece_at[target_square];
+        int promoted_piece  = get_move_promotion(move) ? piece : 0;
         bool enpass         = get_move_enpassant(move);
         bool castl          = get_move_castling(move);
 
@@ -504,6 +743,7 @@ void undo_move(Board& b, const StateInfo& st, const int move) {
         b.king_sq[white]   = st.old_king_sq[white];
         b.king_sq[black] = st.old_king_sq[black];
         b.hash = st.old_hash;
+        b.pawn_hash = st.old_pawn_hash;
         b.rep_len = st.old_rep_len;
         b.rep_start = st.old_rep_start;
 
@@ -544,6 +784,9 @@ void undo_move(Board& b, const StateInfo& st, const int move) {
         // 6a) restore fifty move rule
         b.fifty = st.old_fifty;
 
+        // 6b) restore checkers and pins
+        b.check_info = st.old_check_info;
+
         // 7) NNUE
         b.nnue_ply--;
 }
@@ -564,16 +807,121 @@ int make_move_legal(int move, int move_flag, Board& board, StateInfo& st) {
 }
 
 
+// -----------------------------
+// Upcoming repetitions
+// -----------------------------
+namespace {
+
+// cuckoo hash of the key difference of every reversible move (non-pawn piece from s1 to s2 on
+// an empty board, side to move flipped), built at compile time like the Zobrist keys
+inline constexpr int cuckoo_size = 8192;
+
+constexpr int cuckoo_h1(U64 key) { return int(key & 0x1fff); }
+constexpr int cuckoo_h2(U64 key) { return int((key >> 16) & 0x1fff); }
+
+struct CuckooTables {
+    std::array<U64, cuckoo_size>  keys{};
+    std::array<Move, cuckoo_size> moves{};
+};
+
+// can a piece of type pt (white code N..K) go between s1 and s2 on an empty board
+constexpr bool empty_board_reach(int pt, int s1, int s2) {
+    const int df = (s1 & 7) - (s2 & 7), dr = (s1 >> 3) - (s2 >> 3);
+    const int af = df < 0 ? -df : df,    ar = dr < 0 ? -dr : dr;
+    const bool diagonal = af == ar, straight = !af || !ar;
+    switch (pt) {
+        case N:  return (af == 1 && ar == 2) || (af == 2 && ar == 1);
+        case B:  return diagonal;
+        case R:  return straight;
+        case Q:  return diagonal || straight;
+        case K:  return af <= 1 && ar <= 1;
+        default: return false;
+    }
+}
+
+constexpr CuckooTables make_cuckoo() {
+    CuckooTables t{};
+    for (int piece = P; piece <= k; piece++) {
+        if (piece == P || piece == p) continue;
+        for (int s1 = 0; s1 < 64; s1++)
+            for (int s2 = s1 + 1; s2 < 64; s2++) {
+                if (!empty_board_reach(piece % 6, s1, s2)) continue;
+
+                Move move = encode_move(s1, s2);
+                U64 key   = random_pieces[piece * 64 + s1] ^ random_pieces[piece * 64 + s2] ^ random_side;
+
+                // insert, kicking the occupant to its other slot until an empty one is found
+                int i = cuckoo_h1(key);
+                while (true) {
+                    const U64 k_old  = t.keys[i];  t.keys[i]  = key;  key  = k_old;
+                    const Move m_old = t.moves[i]; t.moves[i] = move; move = m_old;
+                    if (!move) break;
+                    i = (i == cuckoo_h1(key)) ? cuckoo_h2(key) : cuckoo_h1(key);
+                }
+            }
+    }
+    return t;
+}
+
+constexpr CuckooTables cuckoo = make_cuckoo();
+
+// has the position at history index idx already occurred earlier on the reversible stretch
+bool repeated_before(const Board& board, int idx) {
+    for (int i = idx - 4; i >= board.rep_start; i -= 2)
+        if (board.rep_keys[i] == board.rep_keys[idx]) return true;
+    return false;
+}
+
+} // namespace
+
+bool upcoming_repetition(const Board& board, int ply) {
+    const int last = board.rep_len - 1;
+    const int end  = last - board.rep_start; // reversible plies behind the current position
+    if (end < 3) return false;
+
+    const U64 original = board.rep_keys[last];
+    U64 other = original ^ board.rep_keys[last - 1] ^ random_side;
+
+    for (int i = 3; i <= end; i += 2) {
+        // other == 0: the opponent's moves since then cancel out, only ours remain
+        other ^= board.rep_keys[last - i + 1] ^ board.rep_keys[last - i] ^ random_side;
+        if (other) continue;
+
+        const U64 move_key = original ^ board.rep_keys[last - i];
+        int j = cuckoo_h1(move_key);
+        if (cuckoo.keys[j] != move_key) {
+            j = cuckoo_h2(move_key);
+            if (cuckoo.keys[j] != move_key) continue;
+        }
+
+        // the move that undoes the cycle must not be blocked
+        const Move move = cuckoo.moves[j];
+        if (between_bb[get_move_source(move)][get_move_target(move)] & board.occupancies[both]) continue;
+
+        // inside the search tree one repetition is a draw; at or before the root require two
+        if (ply > i || repeated_before(board, last - i)) return true;
+    }
+    return false;
+}
+
 // Null moves
 void make_null_move(Board& board, StateInfo& st){
     st.old_ep = board.enpassant;
     st.old_hash = board.hash;
+    st.old_check_info = board.check_info;
+    st.old_rep_len   = board.rep_len;
+    st.old_rep_start = board.rep_start;
 
     if (board.enpassant != no_sq) board.xor_ep(board.enpassant);
     board.enpassant = no_sq;
     
     board.side^= 1;
     board.hash ^= random_side;
+    set_check_info(board);
+
+    // no repetition can span a null move: keep the history parity and start a new stretch
+    board.rep_start = board.rep_len;
+    board.rep_keys[board.rep_len++] = board.hash;
 
     // nnue ***** TODO: fix to respect NNUE dirty pieces and accumulator evaluation ****
     #if 0
@@ -597,6 +945,9 @@ void restore_null(Board& board, StateInfo& st){
     board.side^=1;
     board.enpassant = st.old_ep;
     board.hash      = st.old_hash;
+    board.check_info = st.old_check_info;
+    board.rep_len    = st.old_rep_len;
+    board.rep_start  = st.old_rep_start;
 
     // nnue
     #if 0
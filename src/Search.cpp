@@ -1,14 +1,50 @@
 #include "Search.hpp"
+#include <algorithm>
 
 namespace bbc{
 
+// correction history slot for the current pawn structure
+static inline int16_t& pawn_correction(const Board& board, SearchContext& sc){
+    return sc.pawn_corr[board.side][board.pawn_hash % CORR_SIZE];
+}
+
+// static eval adjusted by the learned bias of this pawn structure
+static inline int corrected_eval(int raw_eval, const Board& board, SearchContext& sc){
+    int v = raw_eval + pawn_correction(board, sc) / CORR_GRAIN;
+    return std::clamp(v, -MATE + MAX_PLY, MATE - MAX_PLY);
+}
+
+// pull the entry towards (search score - raw eval), trusting deeper searches more
+static inline void update_correction(int raw_eval, int score, int depth, const Board& board, SearchContext& sc){
+    int16_t& entry = pawn_correction(board, sc);
+    int target = std::clamp((score - raw_eval) * CORR_GRAIN, -CORR_MAX, CORR_MAX);
+    int weight = std::min(depth + 1, 16);
+    entry = (entry * (256 - weight) + target * weight) / 256;
+}
+
 // q search at d=0
-int qsearch(int alpha, int beta, Board& board, TranspositionTable& tt, SearchContext& sc){
+int qsearch(int alpha, int beta, Board& board, TranspositionTable& tt, SearchContext& sc, int qply){
+    // 0: TT probe (any stored depth is deep enough for qsearch)
+    TTEntry ent;
+    bool probed = tt.probe(board.hash, ent, 0);
+    if (probed && (ent.node_type == EXACT
+                   || (ent.node_type == LOWER_BOUND && ent.value >= beta)
+                   || (ent.node_type == UPPER_BOUND && ent.value <= alpha))) {
+        tt.inc_used();
+        return ent.value;
+    }
+
+    int alpha0 = alpha;
     bool check = in_check_now(board);
+
     // Stand-pat only if NOT in check
+    int stand = -INF;
     if (!check) {
-        int stand = eval(board);
-        if (stand >= beta) return stand;            // fail-high
+        stand = corrected_eval(eval(board), board, sc);
+        if (stand >= beta) {                        // fail-high
+            tt.store(board.hash, 0, 0, stand, LOWER_BOUND);
+            return stand;
+        }
         if (stand > alpha) alpha = stand;           // raise alpha
     } else {
         // In check: no stand-pat; treat like one-ply extension of evasions
@@ -19,39 +55,61 @@ int qsearch(int alpha, int beta, Board& board, TranspositionTable& tt, SearchCon
     StateInfo st;
 
     if (!check) {
-        generate_moves(ml, board, false);               // captures/promotions only
+        generate_captures(ml, board);               // captures and queen promotions
+        if (qply == 0) generate_quiet_checks(ml, board);
     } else {
-        generate_moves(ml, board);                  // all legal moves (evasions)
+        generate_evasions(ml, board);               // all legal moves out of check
     }
 
-    // sort moves
-    sort_moves(ml, 0, board, tt, sc);
+    // sort moves (hash move first)
+    sort_moves(ml, ent.move, board, tt, sc);
 
     bool any = false;
+    Move bestMove = 0;
     for (int i = 0; i < ml.count; ++i) {
-        int move = ml.moves[i];
-        
+        Move move = ml.moves[i];
+
+        if (!check) {
+            // delta pruning: even winning the victim cannot lift us to alpha (quiet checks are exempt)
+            if (get_move_capture(board, move) && !get_move_promotion(move)) {
+                int victim = board.piece_at[get_move_target(move)];
+                int gain   = (victim == no_piece) ? see_values[P] : see_values[victim]; // enpassant
+                if (stand + gain + DELTA_MARGIN <= alpha) continue;
+            }
+
+            // SEE: skip losing captures and checks that hang the checking piece
+            if (!see_ge(board, move, 0)) continue;
+        }
+
+        tt.prefetch(key_after(board, move));
         if (!make_move(move, all_moves, board, st))
             continue;
 
         any = true;
-        int score = -qsearch(-beta, -alpha, board, tt, sc);
+        int score = -qsearch(-beta, -alpha, board, tt, sc, qply + 1);
 
         undo_move(board, st, move);
 
-        if (score >= beta) return score;            // fail-high / cutoff
-        if (score > alpha) alpha = score;           // best so far
+        if (score >= beta) {                        // fail-high / cutoff
+            tt.store(board.hash, move, 0, score, LOWER_BOUND);
+            return score;
+        }
+        if (score > alpha) {                        // best so far
+            alpha = score;
+            bestMove = move;
+        }
     }
 
     if(check && !any){ // checkmate = in check + no legal moves
         return -MATE+board.ply;
     }
 
+    tt.store(board.hash, bestMove, 0, alpha, (alpha > alpha0) ? EXACT : UPPER_BOUND);
     return alpha;
 }
 
 // from AIMA, game is preserved in global array bitboards[] instead of an input, copy and takeback mimic this operation
-move_utility negamax(int alpha, int beta, int depth, Board& board, TranspositionTable& tt, SearchContext& sc, bool pvNode) {
+move_utility negamax(int alpha, int beta, int depth, Board& board, TranspositionTable& tt, SearchContext& sc, bool pvNode, bool cutNode, int excluded) {
     poll_time(sc); // increment node and check time
 
     if(sc.stop.load(std::memory_order_relaxed)) return {0, 0};
@@ -59,43 +117,63 @@ move_utility negamax(int alpha, int beta, int depth, Board& board, Transposition
     // 0: Three fold rep
     if(board.ply && is_threefold(board)) return {0, 0};
     if(board.fifty >= 100) return {0, 0}; // fifty move rule draw
+
+    // 0a: Upcoming repetition: we can force a draw, so the node is worth at least 0
+    if(board.ply && alpha < 0 && upcoming_repetition(board, board.ply)){
+        alpha = 0;
+        if(alpha >= beta) return {alpha, 0};
+    }
     
-    // 1: Quiescence Search at terminal nodes
-    if (depth == 0) {
+    // 1: Quiescence Search at terminal nodes (negative extensions may undershoot 0)
+    if (depth <= 0) {
         int s = qsearch(alpha, beta, board, tt, sc); 
         return {s, 0};
     }
 
     int alpha0 = alpha;
 
-    // 2: TT probe
+    // 2: TT probe (no cutoffs while verifying a singular move: the entry is for this same node)
     TTEntry ent;
     bool probed = tt.probe(board.hash, ent, depth);
-    if (probed && ent.depth >= depth) {
+    if (probed && !excluded && ent.depth >= depth) {
         if (ent.node_type == EXACT) {
+            tt.inc_used();
             return {ent.value, ent.move};
         }
-        if (ent.node_type == LOWER_BOUND) alpha = std::max(alpha, ent.value);
-        else if (ent.node_type == UPPER_BOUND) beta = std::min(beta, ent.value);
+        if (ent.node_type == LOWER_BOUND) alpha = std::max(alpha, int(ent.value));
+        else if (ent.node_type == UPPER_BOUND) beta = std::min(beta, int(ent.value));
         if (alpha >= beta) {
+            tt.inc_used();
             return {ent.value, ent.move};
         }
     }
 
+    // 2a: No hash move on an expensive node: either reduce by one ply (IIR), or run a
+    //     shallow search first so the TT can seed the move ordering (IID option)
+    if (depth >= IIR_DEPTH && (pvNode || cutNode) && !ent.move && !excluded) {
+        if (sc.iid_enabled) {
+            negamax(alpha, beta, depth - IID_REDUCTION, board, tt, sc, pvNode, cutNode);
+            probed = tt.probe(board.hash, ent, depth);
+        }
+        else depth--;
+    }
+
+    bool check = in_check_now(board);
+    int raw_eval    = check ? -INF : eval(board);
+    int static_eval = check ? -INF : corrected_eval(raw_eval, board, sc);
+
     // 3: Null move 
-    if(sc.null_enabled && !pvNode){
+    if(sc.null_enabled && !pvNode && !excluded){
         if(depth >= 3 && board.ply >= 1){ // sufficient depth
-            int check = in_check_now(board);
             if(!check){ // not in check
                 U64 pieces = board.bitboards[Q] | board.bitboards[R] | board.bitboards[B] | board.bitboards[N] |
                              board.bitboards[q] | board.bitboards[r] | board.bitboards[b] | board.bitboards[n];
                 if(pieces){ // pieces present
-                    int static_eval = eval(board);
                     if(static_eval>=beta){ // sufficient strength to continue
                         StateInfo st;
                         make_null_move(board, st);
                         int R = 2 + depth/6;
-                        move_utility score = negamax(-beta, -beta+1, depth-1-R, board, tt, sc, false);
+                        move_utility score = negamax(-beta, -beta+1, depth-1-R, board, tt, sc, false, !cutNode);
                         restore_null(board, st);
 
                         if(-score.utility >= beta){ //success
@@ -108,38 +186,101 @@ move_utility negamax(int alpha, int beta, int depth, Board& board, Transposition
         }
     }
 
+    // 3b: ProbCut: a good capture that beats beta by a margin at reduced depth will
+    //     almost surely beat beta at full depth (skipped if the TT already says otherwise)
+    int prob_beta = beta + PROBCUT_MARGIN;
+    if (!pvNode && !check && !excluded && depth >= PROBCUT_DEPTH && std::abs(beta) < MATE - MAX_PLY
+        && !(probed && ent.depth >= depth - (PROBCUT_REDUCTION - 1) && ent.value < prob_beta)) {
+        MoveList captures;
+        generate_captures(captures, board);
+        sort_moves(captures, ent.move, board, tt, sc);
+
+        StateInfo st;
+        for (int i = 0; i < captures.count; ++i) {
+            Move move = captures.moves[i];
+
+            // only captures whose exchange alone covers the gap to prob_beta
+            if (!see_ge(board, move, prob_beta - static_eval)) continue;
+            tt.prefetch(key_after(board, move));
+            if (!make_move(move, all_moves, board, st)) continue;
+
+            // cheap qsearch verification first, then the reduced depth search
+            int score = -qsearch(-prob_beta, -prob_beta + 1, board, tt, sc);
+            if (score >= prob_beta)
+                score = -negamax(-prob_beta, -prob_beta + 1, depth - PROBCUT_REDUCTION, board, tt, sc, false, !cutNode).utility;
+
+            undo_move(board, st, move);
+            if (sc.stop.load(std::memory_order_relaxed)) return {0, 0};
+
+            if (score >= prob_beta) {
+                tt.store(board.hash, move, depth - (PROBCUT_REDUCTION - 1), score, LOWER_BOUND);
+                return {score, move};
+            }
+        }
+    }
+
     MoveList ml;
     generate_moves(ml, board);
 
     // 4: Sort better moves first (MVV-LVA, Killer, TT move, captures)
     sort_moves(ml, ent.move, board, tt, sc);
 
+    // positive extensions keep the depth while the ply grows: bound the children's ply so chains
+    // of checks or singular moves cannot run away (and overrun the per-ply tables)
+    const bool may_extend = board.ply + 1 < 2 * sc.root_depth;
+
+    // singular extension candidate: a trusted lower bound from a search nearly as deep as ours
+    bool singular = may_extend && depth >= SINGULAR_DEPTH && board.ply >= 1 && !excluded && probed && ent.move
+                 && ent.node_type != UPPER_BOUND && ent.depth >= depth - 3
+                 && std::abs(ent.value) < MATE - MAX_PLY;
+
     // 5: Try making every legal move
     int bestScore = -INF;
-    int bestMove  = 0;
+    Move bestMove = 0;
     bool hasLegal = false;
 
     StateInfo st;
     bool firstLegal = true;
     for (int i = 0; i < ml.count; ++i) {
-        int move = ml.moves[i];
+        Move move = ml.moves[i];
+
+        if (move == excluded) continue;
+
+        // 5a) Singular extension: search the other moves at reduced depth against a
+        //     bar just below the TT score; if all of them fail low the hash move is forced
+        int extension = 0;
+        if (singular && move == ent.move) {
+            int s_beta  = ent.value - SINGULAR_MARGIN * depth;
+            int s_depth = (depth - 1) / 2;
+            move_utility s = negamax(s_beta - 1, s_beta, s_depth, board, tt, sc, false, cutNode, move);
+
+            if (s.utility < s_beta) extension = 1;          // only move holding the score
+            else if (s_beta >= beta) return {s_beta, move}; // multi-cut: several moves beat beta
+            else if (ent.value >= beta) extension = -1;     // alternatives fine, hash move less urgent
+        }
 
+        // child TT line starts loading while make_move runs
+        tt.prefetch(key_after(board, move));
         if (!make_move(move, all_moves, board, st)) continue;
 
+        // 5b) Check extension
+        if (extension == 0 && may_extend && in_check_now(board)) extension = 1;
+
         hasLegal = true;
         int score;
+        int new_depth = depth - 1 + extension;
 
-        // 5a) Principal Variation Search (PVS)
+        // 5c) Principal Variation Search (PVS)
         if (pvNode && firstLegal) { // on PV nodes, search full window
-            move_utility child = negamax(-beta, -alpha, depth - 1, board, tt, sc, true);
+            move_utility child = negamax(-beta, -alpha, new_depth, board, tt, sc, true);
             score = -child.utility;
         } 
         else { // on non-PV nodes, search null window 
-            move_utility child = negamax(-alpha - 1, -alpha, depth - 1, board, tt, sc, false);
+            move_utility child = negamax(-alpha - 1, -alpha, new_depth, board, tt, sc, false, !cutNode);
             score = -child.utility;
 
             if (pvNode && score > alpha && score < beta) { // if not a NULL window and we don't fail low ==> Search full window
-                child = negamax(-beta, -alpha, depth - 1, board, tt, sc, true);
+                child = negamax(-beta, -alpha, new_depth, board, tt, sc, true);
                 score = -child.utility;
             }
         }
@@ -154,9 +295,8 @@ move_utility negamax(int alpha, int beta, int depth, Board& board, Transposition
             if (score > alpha) {
                 alpha = score;
                 if (alpha >= beta) {
-                    storeKillerMove(move, board.ply, sc);
-                    tt.store(board.hash, move, depth, bestScore, LOWER_BOUND);
-                    return {bestScore, bestMove};
+                    storeKillerMove(move, board, sc);
+                    break;
                 }
             }
         }
@@ -164,7 +304,7 @@ move_utility negamax(int alpha, int beta, int depth, Board& board, Transposition
 
     // 6: Check for checkmate
     if (!hasLegal) {
-        bool check = in_check_now(board);
+        if (excluded) return {alpha, 0};           // only the excluded move was legal
         if (check)  return {-MATE+board.ply, 0}; // or -MATE + ply for mate distance
         return {0, 0};                  // stalemate
     }
@@ -175,7 +315,18 @@ move_utility negamax(int alpha, int beta, int depth, Board& board, Transposition
         (bestScore >= beta)   ? LOWER_BOUND :
                                EXACT;
 
-    tt.store(board.hash, bestMove, depth, bestScore, t);
+    if (!excluded) tt.store(board.hash, bestMove, depth, bestScore, t);
+
+    // 8: Learn the eval bias of this pawn structure from quiet nodes whose bound
+    //    actually says something about the static eval (no tactics, no mates)
+    if (!check && !excluded && !sc.stop.load(std::memory_order_relaxed)
+        && !(bestMove && (get_move_capture(board, bestMove) || get_move_promotion(bestMove)))
+        && std::abs(bestScore) < MATE - MAX_PLY
+        && !(t == LOWER_BOUND && bestScore <= static_eval)
+        && !(t == UPPER_BOUND && bestScore >= static_eval)) {
+        update_correction(raw_eval, bestScore, depth, board, sc);
+    }
+
     return {bestScore, bestMove};
 }
 
@@ -188,10 +339,7 @@ move_utility iterative_deepening(int depth, TimeContext& tc, Board& board, Trans
         U64 cur_time = get_time_ms();
         U64 cur_nodes = sc.nodes;
 
-        g_refreshes = 0; // DEBUG
-        g_updates   = 0;
-        g_evals     = 0;
-
+        sc.root_depth = i;
         move_utility cur_move = negamax(-INF, INF, i, board, tt, sc, true);
         if(sc.stop.load(std::memory_order_relaxed)) break; // terminated early, don't use this
 
@@ -200,6 +348,7 @@ move_utility iterative_deepening(int depth, TimeContext& tc, Board& board, Trans
 
         best = cur_move;
         reached++;
+        sc.completed_depth = i;
 
         if(DEBUG) printf("Nodes: %lld Time: %lld\n", sc.nodes, get_time_ms()-sc.start); // print time taken for each depth
         
@@ -207,15 +356,15 @@ move_utility iterative_deepening(int depth, TimeContext& tc, Board& board, Trans
         U64 elapsed_nodes = sc.nodes -cur_nodes;
         U64 nps = elapsed_time ? (elapsed_nodes * 1000) / elapsed_time : elapsed_nodes;
 
-        printf("info depth %d score cp %d nodes %llu nps %llu time %llu\n",
+        if(!sc.silent) printf("info depth %d score cp %d nodes %llu nps %llu hashfull %d time %llu\n",
             i,
             best.utility,
             (unsigned long long)sc.nodes,
             nps,   // sc.nodes / elapsed_ms * 1000
+            tt.hashfull(),
             elapsed_time
         );
 
-        // printf("info string refreshes %d updates %d evals %d\n", g_refreshes, g_updates, g_evals); // DEBUG
         
         // 1) Terminate on soft time
         if(elapsed_time >= sc.soft) break; 
@@ -1,62 +1,284 @@
 # include "TT.hpp"
+# include "Threads.hpp"
+# include "misc.hpp"
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
 
 namespace bbc{
 
 // constructor
-TranspositionTable::TranspositionTable(size_t mb){
-    size_t bytes = mb * 1024 * 1024;
-    size_t num_entries = bytes / sizeof(TTEntry);
-    num_entries = (1 << std::__lg(num_entries));
-
-    table = new TTEntry[num_entries]();
-    size = num_entries;
-
-    // debugging
-    probed = 0;
-    invalid_table_moves = 0;
-    stored = 0;
-    used = 0;
+TranspositionTable::TranspositionTable(size_t mb) : segment_name(), stats(){
+    resize(mb);
 }
 
 // destructor
 TranspositionTable::~TranspositionTable(){
-    delete[] table;
+    release();
 }
 
 // resize
-void TranspositionTable::resize(size_t mb){
+bool TranspositionTable::resize(size_t mb){
+    if(segment){
+        std::printf("info string Hash is ignored while SharedHash is set (segment %s has %zu entries)\n",
+                    segment_name.c_str(), size);
+        return false;
+    }
+
     size_t bytes = mb * 1024 * 1024;
-    size_t num_entries = bytes / sizeof(TTEntry);
-    num_entries = (1 << std::__lg(num_entries)); // use msb for num_entries
+    size_t num_entries = std::max<size_t>(bytes / sizeof(TTSlot), 1);
+    num_entries = size_t(1) << std::__lg(num_entries); // use msb for num_entries
 
-    TTEntry* newTable = new TTEntry[num_entries]();
-    
-    for(int i = 0; i < num_entries; i++){
-        newTable[i] = table[i];
+    if(!allocate(num_entries)){
+        if(!table) std::exit(EXIT_FAILURE); // constructor: no table to fall back on
+        return false;
     }
+    clear();
+    return true;
+}
 
-    delete[] table;
-    table = newTable;
+// entries are indexed by hash & (size - 1), so old ones can't be carried over. The new table
+// is allocated before the old one is released: on failure the old one stays in use
+bool TranspositionTable::allocate(size_t num_entries){
+    int new_huge = 0;
+    TTSlot* new_table = static_cast<TTSlot*>(large_alloc(num_entries * sizeof(TTSlot), &new_huge));
+    if(!new_table){
+        std::printf("info string failed to allocate %zu MB for the transposition table%s\n",
+                    num_entries * sizeof(TTSlot) >> 20, table ? ", keeping the current one" : "");
+        return false;
+    }
 
+    release();
+    table = new_table;
     size = num_entries;
+    huge = new_huge;
+    return true;
+}
+
+// drop the private table or detach from the shared segment (which outlives this process)
+void TranspositionTable::release(){
+    if(segment) shm_detach(segment, segment_bytes);
+    else        large_free(table, size * sizeof(TTSlot), huge);
+
+    table = nullptr;
+    size = 0;
+    segment = nullptr;
+    segment_bytes = 0;
+    segment_name.clear();
+}
+
+// one slice of the table per pool thread, which also spreads the first touch of the pages
+void TranspositionTable::for_each_slice(const std::function<void(size_t start, size_t count)>& fn){
+    const size_t slices = thread_pool.size();
+    const size_t slice  = size / slices;
+
+    thread_pool.run(int(slices), [&](int i, int){
+        const size_t start = i * slice;
+        fn(start, (size_t(i) == slices - 1) ? size - start : slice);
+    });
 }
 
 // clear all entries
 void TranspositionTable::clear(){
-    for(size_t i = 0; i < size; i++){
-        table[i] = TTEntry();
+    if(segment) return;
+
+    for_each_slice([&](size_t start, size_t count){
+        std::memset(static_cast<void*>(table + start), 0, count * sizeof(TTSlot));
+    });
+}
+
+// -----------------------------
+// Hash files and shared segments
+// -----------------------------
+namespace {
+
+// bump when TTSlot, its packing or the header changes
+constexpr uint32_t TT_FILE_VERSION = 2;
+constexpr char TT_FILE_MAGIC[8] = {'B', 'B', 'C', 'H', 'A', 'S', 'H', '\0'};
+
+struct TTFileHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t entry_size;
+    U64      entries;
+    U64      zobrist;       // checksum of the keys the entries were hashed with
+    uint32_t generation;    // in a shared segment, the last search started by any process
+    uint32_t reserved;
+};
+static_assert(sizeof(TTFileHeader) == 40, "hash file header layout");
+
+// a shared segment is a header followed by the table, which starts on its own cache line
+constexpr size_t TT_SEGMENT_OFFSET = 64;
+
+TTFileHeader make_header(size_t entries, uint32_t generation){
+    TTFileHeader header{};
+    std::memcpy(header.magic, TT_FILE_MAGIC, sizeof(header.magic));
+    header.version    = TT_FILE_VERSION;
+    header.entry_size = sizeof(TTSlot);
+    header.entries    = entries;
+    header.zobrist    = zobrist_checksum();
+    header.generation = generation;
+    return header;
+}
+
+// nullptr if header describes a table of this engine's format filling bytes after offset
+const char* check_header(const TTFileHeader& header, size_t bytes, size_t offset){
+    if(bytes < offset) return "truncated";
+    if(std::memcmp(header.magic, TT_FILE_MAGIC, sizeof(header.magic)) != 0) return "not a hash file";
+    if(header.version != TT_FILE_VERSION || header.entry_size != sizeof(TTSlot)) return "entry format differs";
+    if(header.zobrist != zobrist_checksum()) return "hashed with different Zobrist keys";
+    if(!header.entries || (header.entries & (header.entries - 1))) return "bad entry count";
+    // compare counts, not byte sizes: entries * sizeof(TTSlot) can overflow in a crafted header
+    if(header.entries != (bytes - offset) / sizeof(TTSlot) || (bytes - offset) % sizeof(TTSlot)) return "truncated";
+    return nullptr;
+}
+
+// runs once, on a segment the first process just created (zero filled: every slot empty)
+void init_segment(void* mem, size_t bytes){
+    const TTFileHeader header = make_header((bytes - TT_SEGMENT_OFFSET) / sizeof(TTSlot), 0);
+    std::memcpy(mem, &header, sizeof(header));
+}
+
+// data word layout: move | value << 16 | depth << 32 | node_type << 48 | generation << 56
+inline U64 pack(Move move, int value, int depth, int node_type, uint8_t generation){
+    return U64(move) | U64(uint16_t(value)) << 16 | U64(uint16_t(depth)) << 32
+         | U64(uint8_t(node_type)) << 48 | U64(generation) << 56;
+}
+
+inline TTEntry unpack(U64 key, U64 data){
+    return {key, Move(data), int16_t(data >> 16), int16_t(data >> 32), uint8_t(data >> 48), uint8_t(data >> 56)};
+}
+
+// slot words may be written concurrently by other threads or processes
+inline U64 load_word(const U64& word){ return __atomic_load_n(&word, __ATOMIC_RELAXED); }
+inline void store_word(U64& word, U64 value){ __atomic_store_n(&word, value, __ATOMIC_RELAXED); }
+
+} // namespace
+
+bool TranspositionTable::share(const std::string& name){
+    if(name.empty()){
+        if(!segment) return true;
+        const std::string name_before = segment_name;
+        if(!allocate(size)) return false;
+        clear();
+        std::printf("info string SharedHash detached from %s\n", name_before.c_str());
+        return true;
     }
+
+    // POSIX segment names are a single component starting with a slash
+    const std::string shm_name = name[0] == '/' ? name : "/" + name;
+    if(segment && shm_name == segment_name) return true;
+
+    size_t bytes = TT_SEGMENT_OFFSET + size * sizeof(TTSlot);
+    void* mem = shm_attach(shm_name.c_str(), &bytes, init_segment);
+    if(!mem){
+        std::printf("info string SharedHash cannot map %s, keeping a private table\n", shm_name.c_str());
+        return false;
+    }
+
+    // an existing segment too short for the header isn't one of ours
+    TTFileHeader header{};
+    if(bytes >= TT_SEGMENT_OFFSET) std::memcpy(&header, mem, sizeof(header));
+    if(const char* error = check_header(header, bytes, TT_SEGMENT_OFFSET)){
+        std::printf("info string SharedHash %s: %s, keeping a private table\n", shm_name.c_str(), error);
+        shm_detach(mem, bytes);
+        return false;
+    }
+
+    release();
+    segment = mem;
+    segment_bytes = bytes;
+    segment_name = shm_name;
+    table = reinterpret_cast<TTSlot*>(static_cast<char*>(mem) + TT_SEGMENT_OFFSET);
+    size = header.entries;
+
+    std::printf("info string SharedHash %s entries %zu\n", segment_name.c_str(), size);
+    return true;
+}
+
+bool TranspositionTable::save(const char* path) const {
+    std::FILE* f = std::fopen(path, "wb");
+    if(!f){
+        std::printf("info string savehash cannot open %s\n", path);
+        return false;
+    }
+
+    const TTFileHeader header = make_header(size, generation);
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1
+           && std::fwrite(table, sizeof(TTSlot), size, f) == size;
+    ok = (std::fclose(f) == 0) && ok;
+
+    if(ok) std::printf("info string savehash %s entries %zu\n", path, size);
+    else   std::printf("info string savehash failed writing %s\n", path);
+    return ok;
+}
+
+bool TranspositionTable::load(const char* path){
+    FD fd = open_file(path);
+    if(fd == FD_ERR){
+        std::printf("info string loadhash cannot open %s\n", path);
+        return false;
+    }
+    const size_t bytes = file_size(fd);
+    map_t mapping;
+    const void* data = bytes >= sizeof(TTFileHeader) ? map_file(fd, &mapping) : nullptr;
+    close_file(fd);
+    if(!data){
+        std::printf("info string loadhash %s is not a hash file\n", path);
+        return false;
+    }
+
+    TTFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    const char* error = check_header(header, bytes, sizeof(header));
+    if(!error && segment && header.entries != size) error = "size differs from the shared table";
+
+    if(error){
+        std::printf("info string loadhash %s: %s\n", path, error);
+        unmap_file(data, mapping);
+        return false;
+    }
+
+    // take the file's size (the Hash option keeps its value until set again)
+    if(header.entries != size && !allocate(header.entries)){
+        std::printf("info string loadhash %s: table not loaded\n", path);
+        unmap_file(data, mapping);
+        return false;
+    }
+
+    const TTSlot* entries = reinterpret_cast<const TTSlot*>(static_cast<const char*>(data) + sizeof(header));
+    for_each_slice([&](size_t start, size_t count){
+        std::memcpy(static_cast<void*>(table + start), entries + start, count * sizeof(TTSlot));
+    });
+    generation = uint8_t(header.generation);
+    unmap_file(data, mapping);
+
+    std::printf("info string loadhash %s entries %zu\n", path, size);
+    return true;
 }
 
 // get an entry
 bool TranspositionTable::probe(U64 hash, TTEntry &out, int depth) {
-    int index = hash % size;
+    size_t index = hash & (size - 1);
+    TTStats::bump(stats.probes);
+
+    TTSlot& slot = table[index];
+    const U64 key  = load_word(slot.key);
+    const U64 data = load_word(slot.data);
 
     // only return if the table's stored hash is equivalent
-    if(table[index].key != 0) probed++;
-    if(table[index].key == hash){
-        invalid_table_moves++;
-        out = table[index];
+    if((key ^ data) == hash){
+        TTStats::bump(stats.hits);
+        out = unpack(hash, data);
+
+        // still useful: keep it current
+        if(out.generation != generation){
+            out.generation = generation;
+            const U64 current = pack(out.move, out.value, out.depth, out.node_type, generation);
+            store_word(slot.data, current);
+            store_word(slot.key, hash ^ current);
+        }
         return true;
     }
 
@@ -65,19 +287,73 @@ bool TranspositionTable::probe(U64 hash, TTEntry &out, int depth) {
 
 // store entry inputs into table
 void TranspositionTable::store(U64 hash, int move, int depth, int utility, int node_type){
-    int index = hash % size;
-    stored++;
+    size_t index = hash & (size - 1);
+    TTSlot& slot = table[index];
+    TTStats::bump(stats.stores);
+
+    const U64 key  = load_word(slot.key);
+    const U64 data = load_word(slot.data);
+    const TTEntry entry = unpack(key ^ data, data);
+
     // replace the hash if it has greater depth than current entry
     // ** MIGHT TRY AGING OR OTHER REPLACEMENT TECHNIQUES **
-    if(table[index].depth <= depth || (node_type == EXACT && table[index].node_type != EXACT)){
-        table[index] = {hash, move, depth, utility, node_type};
+    if(entry.depth <= depth || (node_type == EXACT && entry.node_type != EXACT)){
+        if(entry.key == hash) TTStats::bump(stats.overwritten);
+        else if(key)          TTStats::bump(stats.replaced);
+
+        const U64 stored = pack(Move(move), utility, depth, node_type, generation);
+        store_word(slot.data, stored);
+        store_word(slot.key, hash ^ stored);
     }
-    
+    else TTStats::bump(stats.kept);
 }
 
 // increased used moves from table
-void TranspositionTable::inc_used(){ used++; }
+void TranspositionTable::inc_used(){ TTStats::bump(stats.cutoffs); }
 
+void TranspositionTable::new_search(){
+    // processes sharing the table count searches together, so "current" means anyone's latest
+    if(segment) generation = uint8_t(__atomic_add_fetch(&static_cast<TTFileHeader*>(segment)->generation, 1, __ATOMIC_RELAXED));
+    else        generation++;
+    stats.clear();
+}
+
+int TranspositionTable::hashfull(bool current_only) const {
+    const size_t sample = std::min<size_t>(1000, size);
+    size_t count = 0;
+    for(size_t i = 0; i < sample; i++)
+        count += load_word(table[i].key) && (!current_only || uint8_t(load_word(table[i].data) >> 56) == generation);
+    return int(count * 1000 / sample);
+}
+
+void TranspositionTable::report() const {
+    const U64 probes = stats.probes.load(std::memory_order_relaxed);
+    const U64 hits   = stats.hits.load(std::memory_order_relaxed);
+    const U64 cuts   = stats.cutoffs.load(std::memory_order_relaxed);
+    const int occupied = hashfull(false);
+    const int current  = hashfull(true);
 
+    std::printf("info string tt probes %llu hit %.1f%% cutoff %.1f%% stores %llu replaced %llu overwritten %llu kept %llu "
+                "occupied %d permille current %.1f%%\n",
+                (unsigned long long)probes,
+                probes ? 100.0 * hits / probes : 0.0,
+                probes ? 100.0 * cuts / probes : 0.0,
+                (unsigned long long)stats.stores.load(std::memory_order_relaxed),
+                (unsigned long long)stats.replaced.load(std::memory_order_relaxed),
+                (unsigned long long)stats.overwritten.load(std::memory_order_relaxed),
+                (unsigned long long)stats.kept.load(std::memory_order_relaxed),
+                occupied,
+                occupied ? 100.0 * current / occupied : 0.0);
+}
+
+void TTStats::clear(){
+    probes = 0;
+    hits = 0;
+    cutoffs = 0;
+    stores = 0;
+    replaced = 0;
+    overwritten = 0;
+    kept = 0;
+}
 
-}
\ No newline at end of file
+}
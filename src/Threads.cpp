@@ -0,0 +1,78 @@
+# include "Threads.hpp"
+
+namespace bbc{
+
+ThreadPool thread_pool;
+
+ThreadPool::ThreadPool(int threads) : workers(), run_mtx(), mtx(), start_cv(), done_cv(){
+    start_workers(threads);
+}
+
+ThreadPool::~ThreadPool(){
+    stop_workers();
+}
+
+void ThreadPool::resize(int threads){
+    stop_workers();
+    start_workers(threads);
+}
+
+void ThreadPool::start_workers(int threads){
+    if(threads < 1) threads = 1;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    quit = false;
+    // new workers only wait for batches started after this point
+    for(int id = 0; id < threads; id++)
+        workers.emplace_back(&ThreadPool::worker_loop, this, id, generation);
+}
+
+void ThreadPool::stop_workers(){
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        quit = true;
+    }
+    start_cv.notify_all();
+    for(auto& t : workers) t.join();
+    workers.clear();
+}
+
+void ThreadPool::run(int count, const std::function<void(int, int)>& task){
+    if(count <= 0) return;
+
+    std::lock_guard<std::mutex> batch(run_mtx);
+    std::unique_lock<std::mutex> lock(mtx);
+    job = &task;
+    job_count = count;
+    next.store(0, std::memory_order_relaxed);
+    busy = size();
+    generation++;
+    start_cv.notify_all();
+
+    // every worker checks in once per batch, so the task can't outlive this call
+    done_cv.wait(lock, [&]{ return busy == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::worker_loop(int id, unsigned seen){
+    std::unique_lock<std::mutex> lock(mtx);
+
+    while(true){
+        start_cv.wait(lock, [&]{ return quit || generation != seen; });
+        if(quit) return;
+        seen = generation;
+
+        const auto* task = job;
+        const int count = job_count;
+        lock.unlock();
+
+        for(int i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+                i = next.fetch_add(1, std::memory_order_relaxed))
+            (*task)(i, id);
+
+        lock.lock();
+        if(--busy == 0) done_cv.notify_one();
+    }
+}
+
+}
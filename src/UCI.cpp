@@ -1,5 +1,10 @@
 # include "UCI.hpp"
 # include "Perft.hpp"
+# include "Threads.hpp"
+# include "Bench.hpp"
+#include <algorithm>
+#include <cctype>
+#include <memory>
 #include <thread>
 
 namespace bbc{
@@ -13,6 +18,12 @@ static inline bool starts_with(const char* s, const char* pfx) {
     return std::strncmp(s, pfx, std::strlen(pfx)) == 0;
 }
 
+// input is the command name as a whole token ("uci" must not take "ucinewgame")
+static inline bool is_command(const char* input, const char* name) {
+    const size_t n = std::strlen(name);
+    return std::strncmp(input, name, n) == 0 && (input[n] == '\0' || std::isspace((unsigned char)input[n]));
+}
+
 //  user/GUI move string input (e.g. "e7e8q")
 int parse_move(char* move_string, Board& board)
 {
@@ -28,7 +39,7 @@ int parse_move(char* move_string, Board& board)
         if (get_move_source(move) == source_square &&
             get_move_target(move) == target_square)
         {
-            int promoted_piece = get_move_promoted(move);
+            int promoted_piece = get_move_promoted(board, move);
             if (promoted_piece) {
                 // guard for short strings
                 char promo = move_string[4] ? move_string[4] : '\0';
@@ -112,7 +123,7 @@ void parse_position(char* command, Board& board)
 
 // parse UCI "go" command
 void parse_go(const char* command, Board& board, TimeContext& tc,
-              TranspositionTable& tt, SearchContext& sc){
+              TranspositionTable& tt, SearchContext& sc, Experience& exp){
     // inside parse_go(...)
     tc.clear();
     sc.clear();
@@ -158,20 +169,22 @@ void parse_go(const char* command, Board& board, TimeContext& tc,
     sc.start = tc.start;
     sc.stop = false;
 
-    // 3) Calculate budgets
+    // 3) Calculate budgets, signed: the overhead may be larger than the time left
+    const long long left     = (long long)tc.ms_left;
+    const long long overhead = std::clamp<long long>(tc.overhead, 0, left);
     if (movetime > 0) { // one move
-        U64 soft = std::max<U64>(20, tc.ms_left - OVERHEAD - 5);
-        U64 hard = std::min<U64>(tc.ms_left - OVERHEAD,
-                                soft + std::max<long>(30, soft/10));   //  clamp
+        long long usable = left - overhead;
+        long long soft = std::max<long long>(MIN_BUDGET, usable - 5);
+        long long hard = std::max<long long>(soft, std::min<long long>(usable, soft + std::max<long long>(30, soft / 10)));
         sc.soft = soft;
         sc.hard = hard;
     } else if (tc.ms_left > 0) { // time + increment
-        U64 base   = tc.ms_left / 40;               // ~2.5%
-        U64 inc    = (tc.ms_inc) / 2;          // 50% increment
-        U64 budget = std::max<U64>(20, std::min<long>(base + inc, tc.ms_left / 2));
-        U64 hardCap= std::max<U64>(budget, (4 * tc.ms_left) / 5 - OVERHEAD);
+        long long base   = left / 40;                  // ~2.5%
+        long long inc    = (long long)tc.ms_inc / 2;   // 50% increment
+        long long hard   = std::max<long long>(MIN_BUDGET, (4 * left) / 5 - overhead);
+        long long budget = std::clamp<long long>(std::min(base + inc, left / 2), MIN_BUDGET, hard);
         sc.soft = budget;
-        sc.hard = std::max<U64>(20, hardCap);       //  never negative
+        sc.hard = hard;
     } else { //infinite move -- still needs work****
         sc.soft = __LONG_MAX__ / 4;                      //  standard macro
         sc.hard = __LONG_MAX__ / 4;
@@ -181,7 +194,12 @@ void parse_go(const char* command, Board& board, TimeContext& tc,
     int searchDepth = (depth > 0 ? depth : 99);
 
     board.ply = 0; // reset ply at every move
+    tt.new_search();
+    if (int seeded = exp.inject(board, tt))
+        printf("info string experience seeded %d entries\n", seeded);
     move_utility best = iterative_deepening(searchDepth, tc, board, tt, sc);
+    tt.report();
+    exp.record(board, best.move, best.utility, sc.completed_depth);
 
     // Always output something valid
     const std::string bm = move_string(best.move);
@@ -196,7 +214,26 @@ void parse_go(const char* command, Board& board, TimeContext& tc,
 */
 
 // main UCI loop
-void uci_loop(Board& board, TimeContext& tc,  TranspositionTable& tt, SearchContext& sc)
+void init_options(OptionsMap& options, Board& board, TimeContext& tc, TranspositionTable& tt, SearchContext& sc,
+                  Experience& exp)
+{
+    options.add_spin("Hash", 64, 1, MAX_HASH_MB, [&](const Option& o) { return tt.resize(o.as_int()); });
+    options.add_string("SharedHash", "", [&](const Option& o) { return tt.share(o.value); });
+    // Threads sizes the helper pool (TT clear/load, perft); the search itself runs on one thread
+    options.add_spin("Threads", 1, 1, 256, [](const Option& o) { thread_pool.resize(o.as_int()); return true; });
+    options.add_string("EvalFile", DEFAULT_EVAL_FILE, [](const Option& o) {
+        if (nnue::init(o.value.c_str())) return true;
+        std::printf("info string EvalFile %s could not be loaded, keeping the current net\n", o.value.c_str());
+        return false;
+    });
+    options.add_spin("MoveOverhead", int(OVERHEAD), 0, 5000, [&](const Option& o) { tc.overhead = o.as_int(); return true; });
+    options.add_check("UseNNUE", true, [&](const Option& o) { board.use_nnue = o.as_bool(); return true; });
+    options.add_check("IID", false, [&](const Option& o) { sc.iid_enabled = o.as_bool(); return true; });
+    options.add_string("Experience", "", [&](const Option& o) { return exp.open(o.value); });
+}
+
+void uci_loop(Board& board, TimeContext& tc,  TranspositionTable& tt, SearchContext& sc, OptionsMap& options,
+              Experience& exp)
 {
 
     // reset STDIN & STDOUT buffers
@@ -216,7 +253,15 @@ void uci_loop(Board& board, TimeContext& tc,  TranspositionTable& tt, SearchCont
     printf("position startpos moves e2e4 e7e5\n");
     printf("go depth 6\n");
     printf("go movetime 2000\n");
-    printf("perft\n");
+    printf("setoption name Hash value 256\n");
+    printf("savehash analysis.hash / loadhash analysis.hash\n");
+    printf("setoption name Experience value games.exp / expcompact\n");
+    printf("bench 10 16 1\n");
+    printf("perft 6 [fen]\n");
+    printf("divide 5\n");
+    printf("perftsuite [bulk|hash|make|legal] [threads]\n");
+    printf("perftsliders 5\n");
+    printf("checktest 4\n");
     printf("quit\n\n");
 
     // multithread for searching while performing other actions
@@ -241,15 +286,16 @@ void uci_loop(Board& board, TimeContext& tc,  TranspositionTable& tt, SearchCont
         if (input[0] == '\n') continue;
         
         // parse UCI "isready" command
-        if (starts_with(input, "uci")) {
+        if (is_command(input, "uci")) {
             std::printf("id name JJK\n");
             std::printf("id author jasenio\n");
+            options.print_uci();
             std::printf("uciok\n");
         }
-        else if (starts_with(input, "isready")) {
+        else if (is_command(input, "isready")) {
             std::printf("readyok\n");
         }
-        else if (starts_with(input, "ucinewgame")) {
+        else if (is_command(input, "ucinewgame")) {
             sc.stop.store(true, std::memory_order_relaxed); // stop ongoing search
             join_search();
 
@@ -257,61 +303,155 @@ void uci_loop(Board& board, TimeContext& tc,  TranspositionTable& tt, SearchCont
             tc.clear();
             tt.clear();
             sc.clear();         // ensure this resets any stop flag in your search
+            sc.clear_history();
         }
-        else if (starts_with(input, "position")) {
+        else if (is_command(input, "position")) {
             sc.stop.store(true, std::memory_order_relaxed); // stop ongoing search
             join_search();
 
             parse_position(input, board);
         }
-        else if (starts_with(input, "go")) {
+        else if (is_command(input, "go")) {
             sc.stop.store(true, std::memory_order_relaxed); // stop ongoing search
             join_search();
 
             std::string go_cmd = input;
             search_thread = std::thread([&, go_cmd]() {
-                parse_go(go_cmd.c_str(), board, tc, tt, sc);
+                parse_go(go_cmd.c_str(), board, tc, tt, sc, exp);
             });
         }
-        else if (starts_with(input, "stop")) {
+        else if (is_command(input, "stop")) {
             // still needs multithreading *****
             sc.stop.store(true, std::memory_order_relaxed);
             join_search();
         }
-        else if (starts_with(input, "quit")) {
+        else if (is_command(input, "quit")) {
             sc.stop.store(true, std::memory_order_relaxed);
             join_search();
             break;
         }
-        else if (starts_with(input, "setoption")) {
-            // still needs work ****
+        else if (is_command(input, "setoption")) {
+            sc.stop.store(true, std::memory_order_relaxed); // handlers may resize the table
+            join_search();
+
+            options.setoption(input);
         }
-        else if (starts_with(input, "perft")) {
+        else if (is_command(input, "savehash") || is_command(input, "loadhash")) {
             sc.stop.store(true, std::memory_order_relaxed);
             join_search();
 
+            // "savehash <file>" / "loadhash <file>": keep the table across engine restarts
+            char path[1024] = "";
+            if (std::sscanf(input + 8, " %1023[^\r\n]", path) != 1)
+                std::printf("info string usage: %.8s <file>\n", input);
+            else if (input[0] == 's') tt.save(path);
+            else tt.load(path);
+        }
+        else if (is_command(input, "expcompact")) {
+            sc.stop.store(true, std::memory_order_relaxed);
+            join_search();
+
+            // rewrite the experience file with one record per position
+            exp.compact();
+        }
+        else if (is_command(input, "bench")) {
+            sc.stop.store(true, std::memory_order_relaxed);
+            join_search();
+
+            // "bench [depth] [hashMB] [threads]": fixed-depth node count signature and NPS
+            int depth = BENCH_DEPTH, hash_mb = BENCH_HASH_MB, threads = BENCH_THREADS;
+            std::sscanf(input + 5, "%d %d %d", &depth, &hash_mb, &threads);
+            bench(depth, hash_mb, threads);
+        }
+        else if (is_command(input, "checktest")) {
+            sc.stop.store(true, std::memory_order_relaxed);
+            join_search();
+
+            // Dev-only: validate gives_check against make-and-test on the debug positions
+            int depth = 4;
+            std::sscanf(input + 9, "%d", &depth);
+
+            const char* fens[] = { start_position, tricky_position, killer_position, cmk_position };
+            auto test_board = std::make_unique<Board>();
+            U64 total_mismatches = 0;
+            for (const char* fen : fens) {
+                test_board->parse_fen(fen);
+                U64 checks = 0;
+                U64 mismatches = gives_check_driver(*test_board, depth, checks);
+                total_mismatches += mismatches;
+                std::printf("info string checktest checks %llu mismatches %llu fen %s\n",
+                            (unsigned long long)checks, (unsigned long long)mismatches, fen);
+            }
+            std::printf("info string checktest %s\n", total_mismatches ? "FAILED" : "ok");
+        }
+        else if (is_command(input, "perftsliders")) {
+            sc.stop.store(true, std::memory_order_relaxed);
+            join_search();
+
+            // Dev-only: same perft on the current position with each slider backend
+            int depth = 5;
+            std::sscanf(input + 12, "%d", &depth);
+
+            const bool selected = use_pext;
+            for (int backend = 0; backend < 2; ++backend) {
+                if (backend == 1 && !cpu_has_bmi2()) {
+                    std::printf("info string pext unavailable (no BMI2)\n");
+                    break;
+                }
+                use_pext = backend == 1;
+                U64 start = get_time_ms();
+                U64 nodes = perft_driver(board, depth);
+                U64 ms = get_time_ms() - start;
+                std::printf("info string %-5s nodes %llu time %llu nps %llu%s\n",
+                            use_pext ? "pext" : "magic", (unsigned long long)nodes, (unsigned long long)ms,
+                            (unsigned long long)(nodes * 1000 / (ms ? ms : 1)),
+                            use_pext == selected ? " (selected)" : "");
+            }
+            use_pext = selected;
+        }
+        else if (is_command(input, "perftsuite")) {
+            sc.stop.store(true, std::memory_order_relaxed);
+            join_search();
+
+            // Dev-only: known node counts, "perftsuite [bulk|hash|make|legal] [threads]"
+            char name[16] = "bulk";
+            int threads = thread_pool.size();
+            std::sscanf(input + 10, "%15s %d", name, &threads);
+
+            int driver = parse_perft_driver(name);
+            if (driver < 0) std::printf("info string unknown perft driver %s\n", name);
+            else perft_suite(driver, threads);
+        }
+        else if (is_command(input, "divide")) {
+            sc.stop.store(true, std::memory_order_relaxed);
+            join_search();
+
+            // Dev-only: nodes below each root move of the current position
+            int depth = 5;
+            std::sscanf(input + 6, "%d", &depth);
+            perft_test(board, depth, thread_pool.size(), 64);
+        }
+        else if (is_command(input, "perft")) {
+            sc.stop.store(true, std::memory_order_relaxed);
+            join_search();
+
+            // Dev-only: "perft <depth> [fen]" on the given FEN, else on the current position
+            int depth = 6, consumed = 0;
+            std::sscanf(input + 5, "%d%n", &depth, &consumed);
+
+            const char* fen = input + 5 + consumed;
+            while (*fen == ' ') fen++;
+            if (starts_with(fen, "fen ")) fen += 4;
+
+            auto perft_board = std::make_unique<Board>(board);
+            if (*fen && *fen != '\n') perft_board->parse_fen(fen);
 
-            // Dev-only: keep noise off stdout so GUIs aren't confused
-            perft_test(board, 6);
-            int start = get_time_ms();
-            U64 nodes = perft_driver(board, 6);
-            int ms = get_time_ms() - start;
-            std::fprintf(stderr, "perft_normal nodes=%llu time=%dms\n",
-                         (unsigned long long)nodes, ms);
-            
-            // Ablation: perft with legality check
-            // start = get_time_ms();
-            // nodes = perft_driver_legal(board, 6);
-            // ms = get_time_ms() - start;
-            // std::fprintf(stderr, "perft_legal nodes=%llu time=%dms\n",
-            //              (unsigned long long)nodes, ms);
-
-            // Ablation: perft with make_move_simple (no legality check, no undo)
-            // start = get_time_ms();
-            // nodes = perft_driver_simple(board, 6);
-            // ms = get_time_ms() - start;
-            // std::fprintf(stderr, "perft_simple nodes=%llu time=%dms\n",
-            //              (unsigned long long)nodes, ms);
+            U64 start = get_time_ms();
+            U64 nodes = perft_run(*perft_board, depth, perft_bulk, thread_pool.size());
+            U64 ms = get_time_ms() - start;
+            std::printf("info string perft depth %d nodes %llu time %llu nps %llu\n", depth,
+                        (unsigned long long)nodes, (unsigned long long)ms,
+                        (unsigned long long)(nodes * 1000 / (ms ? ms : 1)));
         }
         // else: ignore unknown commands quietly
     }
@@ -10,9 +10,15 @@
 #include "Search.hpp"
 #include "UCI.hpp"
 #include "Engine.hpp"
+#include "Bench.hpp"
+#include "Options.hpp"
+#include "Experience.hpp"
 #include "nn.hpp"
 #include "nnue.hpp"
 
+#include <cstdlib>
+#include <cstring>
+
 namespace bbc{
 
 /**********************************\
@@ -27,17 +33,14 @@ namespace bbc{
 void init_all()
 {
     
-    // init attack pieces
+    // select slider attack backend (attack tables and zobrist keys are compile time)
     init_attacks();
-
-    // init zobrist table
-    init_zobrist_table();
     
     // init magic numbers
     //init_magic_numbers();
 
     // init NNUE
-    nnue::init("src/nn-eba324f53044.nnue");
+    nnue::init(DEFAULT_EVAL_FILE);
 }
 
 /**********************************\
@@ -54,6 +57,25 @@ int engine_main(int argc, char* argv[])
     // init all
     init_all();
 
+    // "myengine bench [depth] [hashMB] [threads]": run the benchmark and exit
+    if (argc > 1 && std::strcmp(argv[1], "bench") == 0) {
+        int depth   = argc > 2 ? std::atoi(argv[2]) : BENCH_DEPTH;
+        int hash_mb = argc > 3 ? std::atoi(argv[3]) : BENCH_HASH_MB;
+        int threads = argc > 4 ? std::atoi(argv[4]) : BENCH_THREADS;
+        bench(depth, hash_mb, threads);
+        return 0;
+    }
+
+    // "myengine expcompact <file>": compact an experience file and exit
+    if (argc > 1 && std::strcmp(argv[1], "expcompact") == 0) {
+        if (argc < 3) {
+            std::printf("usage: %s expcompact <file>\n", argv[0]);
+            return 1;
+        }
+        Experience exp;
+        return exp.open(argv[2]) && exp.compact() ? 0 : 1;
+    }
+
     // init engine variables {board, table, s_context}
     Board board;
     board.parse_fen(start_position);
@@ -68,8 +90,13 @@ int engine_main(int argc, char* argv[])
     SearchContext sc;
     TimeContext tc;
 
+    // UCI options acting on the engine state
+    Experience exp;
+    OptionsMap options;
+    init_options(options, board, tc, tt, sc, exp);
+
     // call uci
-    uci_loop(board, tc, tt, sc);
+    uci_loop(board, tc, tt, sc, options, exp);
 
     return 0;
 }
@@ -77,6 +104,5 @@ int engine_main(int argc, char* argv[])
 }
 
 int main(int argc, char* argv[]) {
-    bbc::engine_main(argc, argv);
-    return 0;
+    return bbc::engine_main(argc, argv);
 }
@@ -1,9 +1,13 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#ifndef _WIN32
+#  include <sys/file.h>
+#endif
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <stdlib.h>
 
 #include "misc.hpp"
 
@@ -78,6 +82,107 @@ void unmap_file(const void *data, map_t map)
 #endif
 }
 
+#define LARGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+
+void *large_alloc(size_t size, int *huge)
+{
+  size = (size + LARGE_PAGE_SIZE - 1) / LARGE_PAGE_SIZE * LARGE_PAGE_SIZE;
+  *huge = 0;
+
+#ifndef _WIN32
+
+  void *mem;
+#ifdef MAP_HUGETLB
+  mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (mem != MAP_FAILED) {
+    *huge = 1;
+    return mem;
+  }
+#endif
+
+  mem = aligned_alloc(LARGE_PAGE_SIZE, size);
+#ifdef MADV_HUGEPAGE
+  if (mem) madvise(mem, size, MADV_HUGEPAGE);
+#endif
+  return mem;
+
+#else
+
+  return _aligned_malloc(size, LARGE_PAGE_SIZE);
+
+#endif
+}
+
+void large_free(void *mem, size_t size, int huge)
+{
+  if (!mem) return;
+
+#ifndef _WIN32
+
+  if (huge) {
+    size = (size + LARGE_PAGE_SIZE - 1) / LARGE_PAGE_SIZE * LARGE_PAGE_SIZE;
+    munmap(mem, size);
+  }
+  else
+    free(mem);
+
+#else
+
+  (void)size; (void)huge;
+  _aligned_free(mem);
+
+#endif
+}
+
+void *shm_attach(const char *name, size_t *size, void (*init)(void *mem, size_t size))
+{
+#ifndef _WIN32
+
+  int fd = shm_open(name, O_RDWR | O_CREAT, 0600);
+  if (fd < 0) return NULL;
+
+  void *mem = NULL;
+  flock(fd, LOCK_EX);
+
+  struct stat statbuf;
+  int created = 0;
+  if (fstat(fd, &statbuf) == 0) {
+    if (statbuf.st_size == 0) {
+      if (ftruncate(fd, (off_t)*size) == 0) created = 1;
+    }
+    else
+      *size = statbuf.st_size;
+
+    if (created || statbuf.st_size > 0) {
+      mem = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (mem == MAP_FAILED) mem = NULL;
+    }
+  }
+  if (mem && created && init) init(mem, *size);
+
+  flock(fd, LOCK_UN);
+  close(fd);
+  return mem;
+
+#else
+
+  (void)name; (void)size; (void)init;
+  return NULL;
+
+#endif
+}
+
+void shm_detach(void *mem, size_t size)
+{
+  if (!mem) return;
+
+#ifndef _WIN32
+  munmap(mem, size);
+#else
+  (void)size;
+#endif
+}
+
 /*
 FEN
 */
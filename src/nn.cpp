@@ -20,12 +20,14 @@ static bool g_loaded = false;
 /**
  * Load the NNUE weights file from disk.
  * Call once at engine startup, before any search begins.
+ * Returns false if the file could not be loaded; a net loaded before stays in use.
  *
  *   bbc::nnue::init("nn-xxxxxxxxxxxxxxxx.nnue");
  */
-void init(const char* path) {
-  nnue_init(path);   // delegates to the C probe library
-  g_loaded = true;
+bool init(const char* path) {
+  bool ok = nnue_init(path);   // delegates to the C probe library
+  g_loaded = g_loaded || ok;
+  return ok;
 }
  
 /**
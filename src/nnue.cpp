@@ -1406,25 +1406,26 @@ Interfaces
 */
 static char *loadedFile = NULL;
 
-DLLExport void _CDECL nnue_init(const char* evalFile)
+DLLExport int _CDECL nnue_init(const char* evalFile)
 {
   if (loadedFile && strcmp(evalFile, loadedFile) == 0)
-    return;
-
-  if (loadedFile)
-    free(loadedFile);
+    return 1;
 
   printf("Loading NNUE : %s\n", evalFile);
   fflush(stdout);
   if (load_eval_file(evalFile)) {
+    /* only now: a failed load keeps the previous net and its name */
+    if (loadedFile)
+      free(loadedFile);
     loadedFile = strdup(evalFile);
     printf("NNUE loaded !\n");
     fflush(stdout);
-    return;
+    return 1;
   }
 
   printf("NNUE file not found!\n");
   fflush(stdout);
+  return 0;
 }
 
 DLLExport int _CDECL nnue_evaluate(int player, int* pieces, int* squares)